@@ -722,6 +722,20 @@ auto Binder::BindAExpr(duckdb_libpgquery::PGAExpr *root) -> std::unique_ptr<Boun
   BUSTUB_ASSERT(root, "nullptr");
   auto name = std::string((reinterpret_cast<duckdb_libpgquery::PGValue *>(root->name->head->data.ptr_value))->val.str);
 
+  if (root->kind == duckdb_libpgquery::PG_AEXPR_BETWEEN || root->kind == duckdb_libpgquery::PG_AEXPR_NOT_BETWEEN) {
+    // `x BETWEEN a AND b` is bound as `x >= a AND x <= b`, and `x NOT BETWEEN a AND b` as `x < a OR x > b`
+    auto bounds = BindExpressionList(reinterpret_cast<duckdb_libpgquery::PGList *>(root->rexpr));
+    if (bounds.size() != 2) {
+      throw bustub::Exception("BETWEEN should have 2 bounds");
+    }
+    bool between = root->kind == duckdb_libpgquery::PG_AEXPR_BETWEEN;
+    auto lower =
+        std::make_unique<BoundBinaryOp>(between ? ">=" : "<", BindExpression(root->lexpr), std::move(bounds[0]));
+    auto upper =
+        std::make_unique<BoundBinaryOp>(between ? "<=" : ">", BindExpression(root->lexpr), std::move(bounds[1]));
+    return std::make_unique<BoundBinaryOp>(between ? "and" : "or", std::move(lower), std::move(upper));
+  }
+
   if (root->kind != duckdb_libpgquery::PG_AEXPR_OP) {
     throw bustub::Exception("unsupported op in AExpr");
   }
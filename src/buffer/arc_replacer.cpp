@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : node_store_(num_frames), capacity_(num_frames) {}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> l(latch_);
+
+  bool from_t1 = EvictFromT1();
+  auto &eviction_set = from_t1 ? t1_set_ : t2_set_;
+  if (eviction_set.empty()) {
+    return false;
+  }
+
+  frame_id_t fid = eviction_set.begin()->second;
+  eviction_set.erase(eviction_set.begin());
+  auto &node = node_store_[fid];
+  auto &ghosts = from_t1 ? b1_ : b2_;
+  (from_t1 ? t1_size_ : t2_size_)--;
+  if (node.page_id_ != INVALID_PAGE_ID) {
+    ghosts.Push(node.page_id_);
+  }
+  node = ARCNode();
+  curr_size_--;
+  TrimGhosts();
+  *frame_id = fid;
+  return true;
+}
+
+auto ARCReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> l(latch_);
+
+  std::vector<frame_id_t> candidates;
+  auto order = EvictFromT1() ? std::make_pair(&t1_set_, &t2_set_) : std::make_pair(&t2_set_, &t1_set_);
+  for (auto *eviction_set : {order.first, order.second}) {
+    for (auto it = eviction_set->begin(); it != eviction_set->end() && candidates.size() < max_count; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::lock_guard<std::mutex> l(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < node_store_.size() && frame_id >= 0, "frame id out of replacer size");
+
+  auto &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (node.list_ == List::None) {
+    node.page_id_ = page_id;
+    node.key_ = current_timestamp_++;
+    node.list_ = List::T1;
+    if (!is_scan && page_id != INVALID_PAGE_ID) {
+      // a ghost hit tells which list was too small, T1 grows on a hit in B1 and shrinks on a hit in B2
+      if (b1_.Contains(page_id)) {
+        p_ = std::min(capacity_, p_ + std::max<size_t>(1, b2_.Size() / b1_.Size()));
+        b1_.Erase(page_id);
+        node.list_ = List::T2;
+      } else if (b2_.Contains(page_id)) {
+        p_ -= std::min(p_, std::max<size_t>(1, b1_.Size() / b2_.Size()));
+        b2_.Erase(page_id);
+        node.list_ = List::T2;
+      }
+    }
+    (node.list_ == List::T1 ? t1_size_ : t2_size_)++;
+    TrimGhosts();
+    return;
+  }
+
+  if (is_scan) {
+    return;
+  }
+  if (node.is_evictable_) {
+    EvictionSetOf(node).erase({node.key_, frame_id});
+  }
+  if (node.list_ == List::T1) {
+    t1_size_--;
+    t2_size_++;
+    node.list_ = List::T2;
+  }
+  node.key_ = current_timestamp_++;
+  if (node.is_evictable_) {
+    EvictionSetOf(node).insert({node.key_, frame_id});
+  }
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> l(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < node_store_.size() && frame_id >= 0, "frame id out of replacer size");
+
+  auto &node = node_store_[frame_id];
+  if (node.list_ == List::None || node.is_evictable_ == set_evictable) {
+    return;
+  }
+
+  if (set_evictable) {
+    EvictionSetOf(node).insert({node.key_, frame_id});
+    curr_size_++;
+  } else {
+    EvictionSetOf(node).erase({node.key_, frame_id});
+    curr_size_--;
+  }
+  node.is_evictable_ = set_evictable;
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> l(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < node_store_.size() && frame_id >= 0, "frame id out of replacer size");
+
+  auto &node = node_store_[frame_id];
+  if (node.list_ == List::None) {
+    return;
+  }
+  BUSTUB_ASSERT(node.is_evictable_, "cannot remove a pinned frame");
+
+  EvictionSetOf(node).erase({node.key_, frame_id});
+  (node.list_ == List::T1 ? t1_size_ : t2_size_)--;
+  node = ARCNode();
+  curr_size_--;
+}
+
+auto ARCReplacer::Size() -> size_t { return curr_size_; }
+
+void ARCReplacer::TrimGhosts() {
+  while (b1_.Size() > 0 && t1_size_ + b1_.Size() > capacity_) {
+    b1_.PopOldest();
+  }
+  while (b2_.Size() > 0 && t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * capacity_) {
+    b2_.PopOldest();
+  }
+}
+
+}  // namespace bustub
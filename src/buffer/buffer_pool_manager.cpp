@@ -12,124 +12,868 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <sys/mman.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
 #include "common/exception.h"
 #include "common/macros.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+BufferPoolManager::BufferPoolInstance::BufferPoolInstance(size_t index, Page *frames, size_t size,
+                                                          std::unique_ptr<Replacer> replacer)
+    : index_(index),
+      size_(size),
+      frames_(frames),
+      next_extent_page_id_(static_cast<page_id_t>(index) * BUFFER_POOL_EXTENT_SIZE),
+      replacer_(std::move(replacer)),
+      frame_states_(size, FrameState::Ready),
+      io_done_(size),
+      prefetched_(size, false),
+      sketch_(size),
+      probation_pos_(size, probation_.end()) {
+  // Initially, every frame is in the free list.
+  for (size_t i = 0; i < size_; ++i) {
+    free_list_.emplace_back(static_cast<int>(i));
+  }
+}
+
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                     LogManager *log_manager, size_t num_instances, ReplacerPolicy replacer_policy)
+    : pool_size_(pool_size),
+      disk_manager_(disk_manager),
+      disk_scheduler_(std::make_unique<DiskScheduler>(disk_manager)),
+      log_manager_(log_manager),
+      replacer_k_(replacer_k),
+      replacer_policy_(replacer_policy) {
   // TODO(students): remove this line after you have implemented the buffer pool manager
   // throw NotImplementedException(
   //     "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
   //     "exception line in `buffer_pool_manager.cpp`.");
 
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];                                      //
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);  //
+  // every instance needs at least one frame
+  num_instances = std::max<size_t>(1, std::min(num_instances, pool_size_));
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+  // we allocate a consecutive memory space for the buffer pool, and hand out a slice of it to every instance
+  pages_ = new Page[pool_size_];
+  if (disk_manager_->IsDirectIo()) {
+    frame_arena_size_ = pool_size_ * BUSTUB_PAGE_SIZE;
+    void *arena = mmap(nullptr, frame_arena_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (arena == MAP_FAILED) {
+      delete[] pages_;
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the frames of the buffer pool");
+    }
+    frame_arena_ = static_cast<char *>(arena);
+#ifdef MADV_HUGEPAGE
+    if (BUFFER_POOL_HUGE_PAGES) {
+      // only a hint, the kernel may not have huge pages to spare
+      madvise(frame_arena_, frame_arena_size_, MADV_HUGEPAGE);
+    }
+#endif
+    for (size_t i = 0; i < pool_size_; ++i) {
+      pages_[i].SetBuffer(frame_arena_ + i * BUSTUB_PAGE_SIZE);
+    }
+  }
+  size_t offset = 0;
+  for (size_t i = 0; i < num_instances; ++i) {
+    size_t size = pool_size_ / num_instances + (i < pool_size_ % num_instances ? 1 : 0);
+    instances_.emplace_back(std::make_unique<BufferPoolInstance>(i, pages_ + offset, size,
+                                                                 MakeReplacer(replacer_policy, size, replacer_k)));
+    offset += size;
+  }
+
+  // after a restart, allocate past the pages already in the file: the instance owning the last extent of the file
+  // hands out the rest of it, the other instances start with an extent of their own. The pages that the extents of
+  // tables and indexes had left before the end of the file are in the free page map, and are reused like deallocated
+  // ones.
+  page_id_t num_pages = disk_manager_->GetNumPages();
+  page_id_t first_unused_extent = (num_pages + BUFFER_POOL_EXTENT_SIZE - 1) / BUFFER_POOL_EXTENT_SIZE;
+  auto stride = static_cast<page_id_t>(num_instances);
+  for (auto &instance : instances_) {
+    auto index = static_cast<page_id_t>(instance->index_);
+    page_id_t extent = first_unused_extent + (index - first_unused_extent % stride + stride) % stride;
+    instance->next_extent_page_id_ = extent * BUFFER_POOL_EXTENT_SIZE;
+  }
+  if (num_pages % BUFFER_POOL_EXTENT_SIZE != 0) {
+    auto &extent = InstanceOf(num_pages).extent_;
+    extent.next_page_id_ = num_pages;
+    extent.end_page_id_ = first_unused_extent * BUFFER_POOL_EXTENT_SIZE;
+  }
+  for (page_id_t page_id : disk_manager_->GetFreePages()) {
+    if (page_id < num_pages) {
+      InstanceOf(page_id).free_pages_.insert(page_id);
+    }
+  }
+}
+
+BufferPoolManager::~BufferPoolManager() {
+  StopPageCleaner();
+  // the completion of a read ahead schedules the next one, the chains have to end while the scheduler still exists
+  prefetch_stopped_ = true;
+  for (auto &instance : instances_) {
+    auto lock = LockInstance(*instance);
+    instance->prefetch_done_.wait(lock, [&] { return instance->prefetching_ == 0; });
+  }
+  // stop the workers before the frames they may write from go away
+  disk_scheduler_.reset();
+  delete[] pages_;
+  if (frame_arena_ != nullptr) {
+    munmap(frame_arena_, frame_arena_size_);
+  }
+}
+
+auto BufferPoolManager::AcquireFrame(BufferPoolInstance &instance, frame_id_t *frame_id, page_id_t *victim_page_id,
+                                     page_id_t page_id) -> bool {
+  *victim_page_id = INVALID_PAGE_ID;
+  bool probationary = false;
+  bool evict = false;
+  if (!ChooseVictim(instance, page_id, frame_id, &probationary, &evict)) {
+    return false;
+  }
+  LeaveProbation(instance, *frame_id);
+  if (probationary) {
+    instance.probation_pos_[*frame_id] = instance.probation_.insert(instance.probation_.end(), *frame_id);
+  }
+  if (!evict) {
+    return true;
+  }
+  stats_.evictions_++;
+
+  auto &page = instance.frames_[*frame_id];
+  instance.page_table_.erase(page.page_id_);
+  if (compressed_cache_ != nullptr) {
+    // a dirty page is stored as it is about to be written back, fetchers wait for the write back before they look
+    if (size_t bytes = compressed_cache_->Put(page.page_id_, page.data_); bytes > 0) {
+      stats_.compressed_stores_++;
+      stats_.compressed_bytes_ += bytes;
+    }
+  }
+  if (instance.prefetched_[*frame_id]) {
+    instance.prefetched_[*frame_id] = false;
+    stats_.prefetch_wasted_++;
+  }
+  if (page.IsDirty()) {
+    stats_.dirty_evictions_++;
+    // the page cleaner is falling behind, it should not wait for its next round
+    cleaner_kicked_ = true;
+    cleaner_cv_.notify_one();
+    // until the content reaches the disk, fetchers of the victim have to wait for this frame instead of reading it
+    instance.write_back_table_.emplace(page.page_id_, *frame_id);
+    *victim_page_id = page.page_id_;
+    page.is_dirty_ = false;
+  }
+  return true;
+}
+
+auto BufferPoolManager::FillFrame(BufferPoolInstance &instance, std::unique_lock<std::mutex> &lock,
+                                  frame_id_t frame_id, page_id_t victim_page_id, bool read_from_disk) -> bool {
+  auto &page = instance.frames_[frame_id];
+  auto &state = instance.frame_states_[frame_id];
+
+  if (victim_page_id != INVALID_PAGE_ID) {
+    state = FrameState::WritingBack;
+    lock.unlock();
+    bool written = disk_scheduler_->ScheduleIo(true, victim_page_id, page.data_).get();
+    lock.lock();
+    instance.write_back_table_.erase(victim_page_id);
+    if (!written) {
+      // the frame is the only copy of the victim now, which stays resident
+      RestoreVictim(instance, frame_id, page.page_id_, victim_page_id);
+      instance.io_done_[frame_id].notify_all();
+      return false;
+    }
+    instance.io_done_[frame_id].notify_all();
+  }
+
+  state = FrameState::Loading;
+  lock.unlock();
+  if (read_from_disk && !LoadFromCompressedCache(page.page_id_, page.data_)) {
+    auto start = std::chrono::steady_clock::now();
+    disk_scheduler_->ScheduleIo(false, page.page_id_, page.data_).get();
+    stats_.disk_read_latency_.Record(std::chrono::steady_clock::now() - start);
+  } else if (!read_from_disk) {
+    page.ResetMemory();
+  }
+  lock.lock();
+  state = FrameState::Ready;
+  instance.io_done_[frame_id].notify_all();
+  return true;
+}
+
+auto BufferPoolManager::ChooseVictim(BufferPoolInstance &instance, page_id_t page_id, frame_id_t *frame_id,
+                                     bool *probationary, bool *evict) -> bool {
+  auto take_free_frame = [&] {
+    *frame_id = instance.free_list_.front();
+    instance.free_list_.pop_front();
+    *evict = false;
+    return true;
+  };
+  // the frames the probationary area lacks are kept free for the pages the admission filter rejects
+  size_t reserved = 0;
+  bool admission_filter = admission_filter_;
+  if (admission_filter) {
+    size_t probation_size = std::max<size_t>(1, instance.size_ * BUFFER_POOL_PROBATION_PERCENT / 100);
+    reserved = probation_size - std::min(probation_size, instance.probation_.size());
+  }
+  if (admission_filter && page_id != INVALID_PAGE_ID) {
+    auto candidates = instance.replacer_->EvictionCandidates(1);
+    if (!candidates.empty() && instance.probation_pos_[candidates[0]] == instance.probation_.end() &&
+        instance.sketch_.Estimate(page_id) < instance.sketch_.Estimate(instance.frames_[candidates[0]].page_id_)) {
+      *probationary = true;
+      stats_.admission_rejects_++;
+      // the oldest probationary page makes room, or else a reserved frame, rather than the hotter victim
+      for (auto fid : instance.probation_) {
+        if (instance.frames_[fid].pin_count_ == 0) {
+          instance.replacer_->Remove(fid);
+          *frame_id = fid;
+          *evict = true;
+          return true;
+        }
+      }
+      if (!instance.free_list_.empty()) {
+        return take_free_frame();
+      }
+    }
+  }
+  if (instance.free_list_.size() > reserved) {
+    return take_free_frame();
+  }
+  if (instance.replacer_->Evict(frame_id)) {
+    *evict = true;
+    return true;
+  }
+  // nothing can be evicted, the reserved frames are given out after all
+  return !instance.free_list_.empty() && take_free_frame();
+}
+
+void BufferPoolManager::LeaveProbation(BufferPoolInstance &instance, frame_id_t frame_id) {
+  auto &pos = instance.probation_pos_[frame_id];
+  if (pos != instance.probation_.end()) {
+    instance.probation_.erase(pos);
+    pos = instance.probation_.end();
+  }
+}
+
+void BufferPoolManager::RestoreVictim(BufferPoolInstance &instance, frame_id_t frame_id, page_id_t page_id,
+                                      page_id_t victim_page_id) {
+  auto &page = instance.frames_[frame_id];
+  instance.page_table_.erase(page_id);
+  instance.page_table_.emplace(victim_page_id, frame_id);
+  LeaveProbation(instance, frame_id);
+  page.page_id_ = victim_page_id;
+  page.is_dirty_ = true;
+  instance.frame_states_[frame_id] = FrameState::Ready;
+  if (compressed_cache_ != nullptr) {
+    // the frame is newer than the copy stored at eviction
+    compressed_cache_->Erase(victim_page_id);
+  }
+  if ((--page.pin_count_) == 0) {
+    instance.replacer_->SetEvictable(frame_id, true);
+  }
+}
+
+auto BufferPoolManager::LoadFromCompressedCache(page_id_t page_id, char *page_data) -> bool {
+  if (compressed_cache_ == nullptr) {
+    return false;
+  }
+  if (compressed_cache_->Take(page_id, page_data)) {
+    stats_.compressed_hits_++;
+    return true;
+  }
+  stats_.compressed_misses_++;
+  return false;
+}
+
+auto BufferPoolManager::LockInstance(BufferPoolInstance &instance) -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> lock(instance.latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    stats_.latch_waits_++;
+    stats_.latch_wait_ns_ +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+  return lock;
+}
+
+void BufferPoolManager::WaitForWriteBack(BufferPoolInstance &instance, std::unique_lock<std::mutex> &lock,
+                                         page_id_t page_id) {
+  for (auto it = instance.write_back_table_.find(page_id); it != instance.write_back_table_.end();
+       it = instance.write_back_table_.find(page_id)) {
+    instance.io_done_[it->second].wait(lock);
   }
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+auto BufferPoolManager::NewPage(page_id_t *page_id, PageExtent *extent) -> Page * {
+  // refused before a frame is taken, a page of a read-only file could never be allocated
+  if (disk_manager_->IsReadOnly()) {
+    return nullptr;
+  }
+  size_t num_instances = instances_.size();
+  size_t start = next_instance_++;
+  std::unique_lock<std::mutex> extent_lock;
+  if (extent != nullptr) {
+    extent_lock = std::unique_lock<std::mutex>(extent->latch_);
+  }
+
+  // try every instance once, starting from a different one each time
+  for (size_t i = 0; i < num_instances; ++i) {
+    // the rest of a reserved extent can only be created by the instance owning it
+    bool in_extent = extent != nullptr && !extent->IsEmpty();
+    auto &instance = in_extent ? InstanceOf(extent->next_page_id_) : *instances_[(start + i) % num_instances];
+    auto lock = LockInstance(instance);
+
+    frame_id_t fid;
+    page_id_t victim_pid;
+    if (!AcquireFrame(instance, &fid, &victim_pid)) {
+      if (in_extent) {
+        break;
+      }
+      continue;
+    }
+
+    page_id_t new_extent_pid;
+    page_id_t pid = AllocatePage(instance, extent != nullptr ? extent : &instance.extent_, &new_extent_pid);
+    if (extent_lock.owns_lock()) {
+      // the owner may create its next page while this one is being set up
+      extent_lock.unlock();
+    }
+    auto &page = instance.frames_[fid];
+    instance.page_table_.insert({pid, fid});
+    instance.replacer_->RecordAccess(fid, AccessType::Unknown, pid);
+    instance.replacer_->SetEvictable(fid, false);
+    page.pin_count_ = 1;
+    page.page_id_ = pid;
+
+    // a new page has nothing on disk yet, the frame only needs to be cleared
+    if (!FillFrame(instance, lock, fid, victim_pid, false)) {
+      // the page is handed out again later
+      DeallocatePage(pid);
+      break;
+    }
+    lock.unlock();
+    if (new_extent_pid != INVALID_PAGE_ID) {
+      disk_manager_->PreallocatePages(new_extent_pid, BUFFER_POOL_EXTENT_SIZE);
+    }
+
+    *page_id = pid;
+    return &page;
+  }
+
+  stats_.pin_failures_++;
+  return nullptr;
+}
+
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  auto start = std::chrono::steady_clock::now();
+  auto *page = FetchFrame(page_id, access_type);
+  stats_.fetch_latency_.Record(std::chrono::steady_clock::now() - start);
+  return page;
+}
 
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
+auto BufferPoolManager::FetchFrame(page_id_t page_id, AccessType access_type) -> Page * {
+  if (access_type == AccessType::Scan) {
+    disk_manager_->AdviseScan(page_id);
+  }
+  auto &instance = InstanceOf(page_id);
   frame_id_t fid;
-  page_id_t pid;
-  page_id_t pre_page_id;
+  auto lock = LockInstance(instance);
+  WaitForWriteBack(instance, lock, page_id);
+  if (admission_filter_) {
+    instance.sketch_.Increment(page_id);
+  }
 
-  std::lock_guard<std::mutex> l(latch_);
+  while (true) {
+    auto it = instance.page_table_.find(page_id);
+    if (it == instance.page_table_.end()) {
+      break;
+    }
+    fid = it->second;
+    stats_.fetch_hits_[static_cast<size_t>(access_type)]++;
+    if (instance.probation_pos_[fid] != instance.probation_.end()) {
+      LeaveProbation(instance, fid);
+      stats_.admission_promotions_++;
+    }
+    instance.frames_[fid].pin_count_++;
+    instance.replacer_->RecordAccess(fid, access_type, page_id);
+    instance.replacer_->SetEvictable(fid, false);
+    if (instance.prefetched_[fid]) {
+      instance.prefetched_[fid] = false;
+      stats_.prefetch_hits_++;
+    }
+    // the pin keeps the frame in place while another thread may still be loading it
+    instance.io_done_[fid].wait(lock, [&] { return instance.frame_states_[fid] == FrameState::Ready; });
+    if (instance.frames_[fid].page_id_ == page_id) {
+      return &instance.frames_[fid];
+    }
+    // the previous page of the frame could not be written back and took the frame back, look again
+    if ((--instance.frames_[fid].pin_count_) == 0) {
+      instance.replacer_->SetEvictable(fid, true);
+    }
+  }
 
-  if (!free_list_.empty()) {
-    fid = free_list_.front();
-    free_list_.pop_front();
-  } else if (replacer_->Evict(&fid)) {
-    pre_page_id = pages_[fid].page_id_;
-    page_table_.erase(pre_page_id);
+  stats_.fetch_misses_[static_cast<size_t>(access_type)]++;
+  page_id_t victim_pid;
+  if (!AcquireFrame(instance, &fid, &victim_pid, page_id)) {
+    stats_.pin_failures_++;
+    return nullptr;
+  }
 
-  } else {
+  auto &page = instance.frames_[fid];
+  instance.page_table_.insert({page_id, fid});
+  instance.replacer_->RecordAccess(fid, access_type, page_id);
+  instance.replacer_->SetEvictable(fid, false);
+  page.pin_count_ = 1;
+  page.page_id_ = page_id;
+
+  if (!FillFrame(instance, lock, fid, victim_pid, true)) {
+    stats_.pin_failures_++;
     return nullptr;
   }
-  pid = AllocatePage();
+  return &page;
+}
 
-  if (pages_[fid].IsDirty()) {
-    disk_manager_->WritePage(pre_page_id, pages_[fid].data_);
-    pages_[fid].is_dirty_ = false;
+auto BufferPoolManager::FetchFrames(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<Page *> {
+  std::vector<page_id_t> sorted(page_ids);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  if (access_type == AccessType::Scan && !sorted.empty()) {
+    disk_manager_->AdviseScan(sorted.front());
   }
 
-  pages_[fid].ResetMemory();
-  disk_manager_->ReadPage(pid, pages_[fid].data_);
-  page_table_.insert({pid, fid});  //
-  replacer_->RecordAccess(fid);
-  replacer_->SetEvictable(fid, false);
+  struct Pin {
+    BufferPoolInstance *instance_;
+    frame_id_t frame_id_;
+    page_id_t victim_page_id_;
+    bool pinned_;
+    bool miss_;
+  };
+  std::vector<Pin> pins(sorted.size(), {nullptr, 0, INVALID_PAGE_ID, false, false});
+  std::unordered_map<BufferPoolInstance *, std::vector<size_t>> batches;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    batches[&InstanceOf(sorted[i])].push_back(i);
+  }
 
-  *page_id = pid;
+  // pin the resident pages first, so that no page of the batch is evicted for another one, then reserve frames for
+  // the others; each instance latch is taken once
+  for (auto &[instance, batch] : batches) {
+    auto lock = LockInstance(*instance);
+    auto pin_resident = [&, instance = instance](size_t i) {
+      auto it = instance->page_table_.find(sorted[i]);
+      if (it == instance->page_table_.end()) {
+        return false;
+      }
+      auto &pin = pins[i];
+      pin.instance_ = instance;
+      pin.frame_id_ = it->second;
+      pin.pinned_ = true;
+      stats_.fetch_hits_[static_cast<size_t>(access_type)]++;
+      if (instance->probation_pos_[pin.frame_id_] != instance->probation_.end()) {
+        LeaveProbation(*instance, pin.frame_id_);
+        stats_.admission_promotions_++;
+      }
+      instance->frames_[pin.frame_id_].pin_count_++;
+      instance->replacer_->RecordAccess(pin.frame_id_, access_type, sorted[i]);
+      instance->replacer_->SetEvictable(pin.frame_id_, false);
+      if (instance->prefetched_[pin.frame_id_]) {
+        instance->prefetched_[pin.frame_id_] = false;
+        stats_.prefetch_hits_++;
+      }
+      return true;
+    };
 
-  pages_[fid].pin_count_ = 1;
-  pages_[fid].page_id_ = pid;
-  return &pages_[fid];
+    std::vector<size_t> misses;
+    for (size_t i : batch) {
+      if (admission_filter_) {
+        instance->sketch_.Increment(sorted[i]);
+      }
+      if (instance->write_back_table_.count(sorted[i]) > 0 || !pin_resident(i)) {
+        misses.push_back(i);
+      }
+    }
+    for (size_t i : misses) {
+      page_id_t page_id = sorted[i];
+      WaitForWriteBack(*instance, lock, page_id);
+      if (pin_resident(i)) {
+        continue;
+      }
+
+      auto &pin = pins[i];
+      stats_.fetch_misses_[static_cast<size_t>(access_type)]++;
+      if (!AcquireFrame(*instance, &pin.frame_id_, &pin.victim_page_id_, page_id)) {
+        // the rest of the batch is cut off anyway
+        stats_.pin_failures_++;
+        break;
+      }
+      auto &page = instance->frames_[pin.frame_id_];
+      instance->page_table_.insert({page_id, pin.frame_id_});
+      instance->replacer_->RecordAccess(pin.frame_id_, access_type, page_id);
+      instance->replacer_->SetEvictable(pin.frame_id_, false);
+      page.pin_count_ = 1;
+      page.page_id_ = page_id;
+      instance->frame_states_[pin.frame_id_] =
+          pin.victim_page_id_ == INVALID_PAGE_ID ? FrameState::Loading : FrameState::WritingBack;
+      pin.instance_ = instance;
+      pin.pinned_ = true;
+      pin.miss_ = true;
+    }
+  }
+
+  // write the dirty victims back, all at once
+  std::vector<std::future<bool>> write_backs(sorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    auto &pin = pins[i];
+    if (pin.miss_ && pin.victim_page_id_ != INVALID_PAGE_ID) {
+      write_backs[i] =
+          disk_scheduler_->ScheduleIo(true, pin.victim_page_id_, pin.instance_->frames_[pin.frame_id_].data_);
+    }
+  }
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    auto &pin = pins[i];
+    if (!write_backs[i].valid()) {
+      continue;
+    }
+    bool written = write_backs[i].get();
+    auto lock = LockInstance(*pin.instance_);
+    pin.instance_->write_back_table_.erase(pin.victim_page_id_);
+    if (!written) {
+      // the frame is the only copy of the victim now, which stays resident; the page is dropped from the batch
+      RestoreVictim(*pin.instance_, pin.frame_id_, sorted[i], pin.victim_page_id_);
+      pin.miss_ = false;
+      pin.pinned_ = false;
+      stats_.pin_failures_++;
+    } else {
+      pin.instance_->frame_states_[pin.frame_id_] = FrameState::Loading;
+    }
+    pin.instance_->io_done_[pin.frame_id_].notify_all();
+  }
+
+  // the misses found in the compressed cache need no read
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    auto &pin = pins[i];
+    if (pin.miss_ && LoadFromCompressedCache(sorted[i], pin.instance_->frames_[pin.frame_id_].data_)) {
+      pin.miss_ = false;
+      auto lock = LockInstance(*pin.instance_);
+      pin.instance_->frame_states_[pin.frame_id_] = FrameState::Ready;
+      pin.instance_->io_done_[pin.frame_id_].notify_all();
+    }
+  }
+
+  // read the misses in page id order, a run of consecutive pages with a single request
+  for (size_t begin = 0; begin < sorted.size();) {
+    if (!pins[begin].miss_) {
+      begin++;
+      continue;
+    }
+    size_t end = begin + 1;
+    while (end < sorted.size() && pins[end].miss_ && sorted[end] == sorted[end - 1] + 1) {
+      end++;
+    }
+    std::vector<char *> run;
+    for (size_t i = begin; i < end; ++i) {
+      run.push_back(pins[i].instance_->frames_[pins[i].frame_id_].data_);
+    }
+    auto start = std::chrono::steady_clock::now();
+    disk_manager_->ReadPages(sorted[begin], run);
+    stats_.disk_read_latency_.Record(std::chrono::steady_clock::now() - start);
+    for (size_t i = begin; i < end; ++i) {
+      auto lock = LockInstance(*pins[i].instance_);
+      pins[i].instance_->frame_states_[pins[i].frame_id_] = FrameState::Ready;
+      pins[i].instance_->io_done_[pins[i].frame_id_].notify_all();
+    }
+    begin = end;
+  }
+
+  // the pages past the first failure are not returned, they are unpinned once they are ready. A resident page whose
+  // frame went back to its previous page, as the write back of that page failed, is a failure too
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    auto &pin = pins[i];
+    if (!pin.pinned_) {
+      continue;
+    }
+    auto &instance = *pin.instance_;
+    auto lock = LockInstance(instance);
+    instance.io_done_[pin.frame_id_].wait(lock,
+                                          [&] { return instance.frame_states_[pin.frame_id_] == FrameState::Ready; });
+    if (pages.size() == i && instance.frames_[pin.frame_id_].page_id_ == sorted[i]) {
+      pages.push_back(&instance.frames_[pin.frame_id_]);
+    } else if ((--instance.frames_[pin.frame_id_].pin_count_) == 0) {
+      instance.replacer_->SetEvictable(pin.frame_id_, true);
+    }
+  }
+  return pages;
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  frame_id_t fid;
-  page_id_t pre_page_id;
-  std::lock_guard<std::mutex> l(latch_);
+void BufferPoolManager::PrefetchChain(page_id_t page_id, NextPageFn next_page) {
+  size_t depth = prefetch_depth_;
+  if (depth > 0) {
+    PrefetchChain(page_id, depth, next_page);
+  }
+}
+
+void BufferPoolManager::PrefetchChain(page_id_t page_id, size_t remaining, NextPageFn next_page) {
+  while (remaining > 0 && page_id != INVALID_PAGE_ID) {
+    auto &instance = InstanceOf(page_id);
+    auto lock = LockInstance(instance);
+    if (instance.write_back_table_.count(page_id) > 0) {
+      return;
+    }
 
-  if (page_table_.count(page_id) != 0U) {
-    fid = page_table_[page_id];
-    pages_[fid].pin_count_++;
+    if (auto it = instance.page_table_.find(page_id); it != instance.page_table_.end()) {
+      frame_id_t fid = it->second;
+      auto &page = instance.frames_[fid];
+      // a frame that is still being loaded continues the chain itself once it is read ahead
+      if (instance.frame_states_[fid] != FrameState::Ready) {
+        return;
+      }
+
+      // look up the next page without the instance latch, and never wait for a writer of the page
+      page.pin_count_++;
+      instance.replacer_->SetEvictable(fid, false);
+      lock.unlock();
+      bool latched = page.TryRLatch();
+      if (latched) {
+        page_id = next_page(page.data_);
+        page.RUnlatch();
+      }
+      lock.lock();
+      if ((--page.pin_count_) == 0) {
+        instance.replacer_->SetEvictable(fid, true);
+      }
+      if (!latched) {
+        return;
+      }
+      remaining--;
+      continue;
+    }
+
+    // read-ahead must not take the frames away from the foreground, and is not started during shutdown
+    if (prefetch_stopped_ || instance.prefetching_ >= instance.size_ / PREFETCH_FRAME_SHARE) {
+      return;
+    }
+    frame_id_t fid;
+    page_id_t victim_pid;
+    if (!AcquireFrame(instance, &fid, &victim_pid)) {
+      return;
+    }
+
+    auto &page = instance.frames_[fid];
+    instance.page_table_.insert({page_id, fid});
+    instance.replacer_->RecordAccess(fid, AccessType::Scan, page_id);
+    instance.replacer_->SetEvictable(fid, false);
+    page.pin_count_ = 1;
+    page.page_id_ = page_id;
+    instance.frame_states_[fid] = victim_pid == INVALID_PAGE_ID ? FrameState::Loading : FrameState::WritingBack;
+    instance.prefetched_[fid] = true;
+    instance.prefetching_++;
+    stats_.prefetch_issued_++;
+    lock.unlock();
+
+    PrefetchFrame(instance, fid, victim_pid, remaining, next_page);
+    return;
+  }
+}
+
+void BufferPoolManager::PrefetchFrame(BufferPoolInstance &instance, frame_id_t frame_id, page_id_t victim_page_id,
+                                      size_t remaining, NextPageFn next_page) {
+  auto &page = instance.frames_[frame_id];
+  DiskRequest r;
+  r.data_ = page.data_;
+  r.callback_ = disk_scheduler_->CreatePromise();
+
+  if (victim_page_id != INVALID_PAGE_ID) {
+    r.is_write_ = true;
+    r.page_id_ = victim_page_id;
+    r.on_complete_ = [this, &instance, frame_id, victim_page_id, remaining, next_page](bool written) {
+      {
+        auto l = LockInstance(instance);
+        instance.write_back_table_.erase(victim_page_id);
+        if (!written) {
+          // the frame is the only copy of the victim now, which stays resident, and the read-ahead stops here
+          instance.prefetched_[frame_id] = false;
+          RestoreVictim(instance, frame_id, instance.frames_[frame_id].page_id_, victim_page_id);
+          if ((--instance.prefetching_) == 0) {
+            instance.prefetch_done_.notify_all();
+          }
+          instance.io_done_[frame_id].notify_all();
+          return;
+        }
+        instance.frame_states_[frame_id] = FrameState::Loading;
+        instance.io_done_[frame_id].notify_all();
+      }
+      PrefetchFrame(instance, frame_id, INVALID_PAGE_ID, remaining, next_page);
+    };
   } else {
-    if (!free_list_.empty()) {
-      fid = free_list_.front();
-      free_list_.pop_front();
-    } else if (replacer_->Evict(&fid)) {
-      pre_page_id = pages_[fid].page_id_;
-      page_table_.erase(pre_page_id);
+    r.is_write_ = false;
+    r.page_id_ = page.page_id_;
+    r.on_complete_ = [this, &instance, frame_id, remaining, next_page,
+                      start = std::chrono::steady_clock::now()](bool /* read */) {
+      stats_.disk_read_latency_.Record(std::chrono::steady_clock::now() - start);
+      auto &page = instance.frames_[frame_id];
+      // nobody looks at the frame before it is ready, the next page can be taken without the page latch
+      page_id_t next_page_id = next_page(page.data_);
+      {
+        auto l = LockInstance(instance);
+        instance.frame_states_[frame_id] = FrameState::Ready;
+        if ((--instance.prefetching_) == 0) {
+          instance.prefetch_done_.notify_all();
+        }
+        if ((--page.pin_count_) == 0) {
+          instance.replacer_->SetEvictable(frame_id, true);
+        }
+        instance.io_done_[frame_id].notify_all();
+      }
+      PrefetchChain(next_page_id, remaining - 1, next_page);
+    };
+  }
 
-      if (pages_[fid].IsDirty()) {
-        disk_manager_->WritePage(pre_page_id, pages_[fid].data_);
-        pages_[fid].is_dirty_ = false;
+  disk_scheduler_->Schedule(std::move(r));
+}
+
+void BufferPoolManager::SetReplacerPolicy(ReplacerPolicy replacer_policy) {
+  replacer_policy_ = replacer_policy;
+  for (auto &instance : instances_) {
+    auto l = LockInstance(*instance);
+    instance->replacer_ = MakeReplacer(replacer_policy, instance->size_, replacer_k_);
+    // hand the resident pages over, the frames in the middle of I/O are pinned and made evictable once done
+    for (auto &x : instance->page_table_) {
+      instance->replacer_->RecordAccess(x.second, AccessType::Unknown, x.first);
+      if (instance->frames_[x.second].pin_count_ == 0) {
+        instance->replacer_->SetEvictable(x.second, true);
       }
-      pages_[fid].ResetMemory();
+    }
+  }
+}
 
-    } else {
-      return nullptr;
+void BufferPoolManager::StartPageCleaner(const PageCleanerOptions &options) {
+  StopPageCleaner();
+  cleaner_options_ = options;
+  cleaner_stop_ = false;
+  cleaner_thread_ = std::thread([this] { PageCleanerLoop(); });
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  if (!cleaner_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> l(cleaner_latch_);
+    cleaner_stop_ = true;
+  }
+  cleaner_cv_.notify_one();
+  cleaner_thread_.join();
+}
+
+void BufferPoolManager::PageCleanerLoop() {
+  std::unique_lock<std::mutex> l(cleaner_latch_);
+  while (!cleaner_stop_) {
+    cleaner_cv_.wait_for(l, cleaner_options_.interval_, [&] { return cleaner_stop_ || cleaner_kicked_; });
+    if (cleaner_stop_) {
+      break;
     }
+    cleaner_kicked_ = false;
+    l.unlock();
+    for (auto &instance : instances_) {
+      stats_.cleaner_writes_ += CleanInstance(*instance);
+    }
+    l.lock();
+  }
+}
 
-    page_table_.insert({page_id, fid});
-    disk_manager_->ReadPage(page_id, pages_[fid].data_);
+auto BufferPoolManager::CleanInstance(BufferPoolInstance &instance) -> size_t {
+  auto lock = LockInstance(instance);
 
-    pages_[fid].pin_count_ = 1;
-    pages_[fid].page_id_ = page_id;
+  size_t target = instance.size_ * cleaner_options_.clean_target_percent_ / 100;
+  size_t free_frames = instance.free_list_.size();
+  if (free_frames >= target) {
+    return 0;
   }
 
-  replacer_->SetEvictable(fid, false);
-  replacer_->RecordAccess(fid);  //
+  // with write-ahead logging, a page may only reach the disk after the log records that modified it
+  bool wal = enable_logging && log_manager_ != nullptr;
+  lsn_t persistent_lsn = wal ? log_manager_->GetPersistentLSN() : INVALID_LSN;
 
-  return &pages_[fid];
+  std::vector<frame_id_t> frame_ids;
+  for (auto fid : instance.replacer_->EvictionCandidates(target - free_frames)) {
+    if (frame_ids.size() >= cleaner_options_.max_writes_per_round_) {
+      break;
+    }
+    auto &page = instance.frames_[fid];
+    // the read latch keeps writers out while the page is on its way to disk, a page being written is skipped
+    if (!page.IsDirty() || !page.TryRLatch()) {
+      continue;
+    }
+    if (wal && page.GetLSN() > persistent_lsn) {
+      page.RUnlatch();
+      continue;
+    }
+    page.pin_count_++;
+    instance.replacer_->SetEvictable(fid, false);
+    page.is_dirty_ = false;
+    frame_ids.push_back(fid);
+  }
+  if (frame_ids.empty()) {
+    return 0;
+  }
+
+  // consecutive pages queued one after another are written together by the scheduler
+  std::sort(frame_ids.begin(), frame_ids.end(), [&](frame_id_t a, frame_id_t b) {
+    return instance.frames_[a].page_id_ < instance.frames_[b].page_id_;
+  });
+  std::vector<std::future<bool>> writes;
+  writes.reserve(frame_ids.size());
+  for (auto fid : frame_ids) {
+    auto &page = instance.frames_[fid];
+    writes.emplace_back(disk_scheduler_->ScheduleIo(true, page.page_id_, page.data_));
+  }
+
+  lock.unlock();
+  std::vector<bool> written(frame_ids.size());
+  for (size_t i = 0; i < frame_ids.size(); ++i) {
+    written[i] = writes[i].get();
+    instance.frames_[frame_ids[i]].RUnlatch();
+  }
+  lock.lock();
+
+  // unpinning puts the frames back at the same place in the eviction order
+  size_t num_written = 0;
+  for (size_t i = 0; i < frame_ids.size(); ++i) {
+    auto &page = instance.frames_[frame_ids[i]];
+    if (written[i]) {
+      num_written++;
+    } else {
+      // a failed write leaves the page to the next round
+      page.is_dirty_ = true;
+    }
+    if ((--page.pin_count_) == 0) {
+      instance.replacer_->SetEvictable(frame_ids[i], true);
+    }
+  }
+  return num_written;
 }
 
 auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  std::lock_guard<std::mutex> l(latch_);
-  frame_id_t fid;
+  auto &instance = InstanceOf(page_id);
+  auto l = LockInstance(instance);
 
-  if (page_table_.count(page_id) != 0U) {
-    fid = page_table_[page_id];
-  } else {
+  auto it = instance.page_table_.find(page_id);
+  if (it == instance.page_table_.end()) {
     return false;
   }
 
-  if (pages_[fid].pin_count_ > 0) {
-    if ((--pages_[fid].pin_count_) == 0) {
-      replacer_->SetEvictable(fid, true);
+  frame_id_t fid = it->second;
+  auto &page = instance.frames_[fid];
+  if (page.pin_count_ > 0) {
+    if ((--page.pin_count_) == 0) {
+      instance.replacer_->SetEvictable(fid, true);
     }
     if (is_dirty) {  // 注意这里的细节
-      pages_[fid].is_dirty_ = is_dirty;
+      page.is_dirty_ = is_dirty;
     }
     return true;
   }
@@ -138,62 +882,392 @@ auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unus
 }
 
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> l(latch_);
-
   if (page_id == INVALID_PAGE_ID) {
     return false;
   }
-  if (page_table_.count(page_id) != 0U) {
-    disk_manager_->WritePage(page_id, pages_[page_table_[page_id]].data_);
-    pages_[page_table_[page_id]].is_dirty_ = false;
-    return true;
+
+  auto &instance = InstanceOf(page_id);
+  auto lock = LockInstance(instance);
+
+  auto it = instance.page_table_.find(page_id);
+  if (it == instance.page_table_.end()) {
+    return false;
   }
 
-  return false;
+  // pin the page so that it stays in its frame while being written without the latch
+  frame_id_t fid = it->second;
+  auto &page = instance.frames_[fid];
+  page.pin_count_++;
+  instance.replacer_->SetEvictable(fid, false);
+  instance.io_done_[fid].wait(lock, [&] { return instance.frame_states_[fid] == FrameState::Ready; });
+  if (page.page_id_ != page_id) {
+    // the frame went back to its previous page, whose write back failed
+    if ((--page.pin_count_) == 0) {
+      instance.replacer_->SetEvictable(fid, true);
+    }
+    return false;
+  }
+
+  page.is_dirty_ = false;
+  lock.unlock();
+  bool written = disk_scheduler_->ScheduleIo(true, page_id, page.data_).get();
+  lock.lock();
+  if (!written) {
+    page.is_dirty_ = true;
+  }
+
+  if ((--page.pin_count_) == 0) {
+    instance.replacer_->SetEvictable(fid, true);
+  }
+  return written;
 }
 
 void BufferPoolManager::FlushAllPages() {
-  std::lock_guard<std::mutex> l(latch_);
+  // find the dirty pages of all instances, so that runs of pages spanning several instances are written together
+  std::vector<std::pair<page_id_t, BufferPoolInstance *>> dirty_pages;
+  for (auto &instance : instances_) {
+    auto lock = LockInstance(*instance);
+    for (auto &[page_id, fid] : instance->page_table_) {
+      if (instance->frames_[fid].IsDirty()) {
+        dirty_pages.emplace_back(page_id, instance.get());
+      }
+    }
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end());
 
-  for (auto &x : page_table_) {
-    FlushPage(x.first);
+  // only a window of pages is pinned at a time, which takes at most a share of the frames of every instance, so that
+  // the foreground keeps frames to work with however small the buffer pool is
+  std::unordered_map<BufferPoolInstance *, size_t> pinned;
+  size_t begin = 0;
+  for (size_t end = 0; end < dirty_pages.size(); ++end) {
+    auto *instance = dirty_pages[end].second;
+    size_t limit = std::max<size_t>(1, instance->size_ / FLUSH_FRAME_SHARE);
+    if (end - begin == static_cast<size_t>(BUFFER_POOL_FLUSH_WINDOW) || pinned[instance] == limit) {
+      FlushWindow({dirty_pages.begin() + begin, dirty_pages.begin() + end});
+      pinned.clear();
+      begin = end;
+    }
+    pinned[instance]++;
   }
+  if (begin < dirty_pages.size()) {
+    FlushWindow({dirty_pages.begin() + begin, dirty_pages.end()});
+  }
+
+  // page writes are not synced one by one, this is where they become durable
+  disk_manager_->Sync();
+}
+
+void BufferPoolManager::FlushWindow(const std::vector<std::pair<page_id_t, BufferPoolInstance *>> &pages) {
+  struct Flush {
+    BufferPoolInstance *instance_;
+    frame_id_t frame_id_;
+  };
+
+  // pin the pages that are still resident and dirty
+  std::vector<Flush> flushes;
+  for (auto &[page_id, instance] : pages) {
+    auto lock = LockInstance(*instance);
+    auto it = instance->page_table_.find(page_id);
+    if (it == instance->page_table_.end() || instance->frame_states_[it->second] != FrameState::Ready ||
+        !instance->frames_[it->second].IsDirty()) {
+      continue;
+    }
+    instance->frames_[it->second].pin_count_++;
+    instance->replacer_->SetEvictable(it->second, false);
+    flushes.push_back({instance, it->second});
+  }
+
+  // the read latch keeps writers out while a page is on its way to disk, so that it is written whole and can be marked
+  // clean once written. It is only tried: the pages held by a writer right now are tried again a few times, and then
+  // left dirty, since waiting for a latch could deadlock, e.g. if the writer is the thread flushing
+  std::vector<Flush> busy = flushes;
+  for (int attempt = 0; !busy.empty() && attempt <= BUFFER_POOL_FLUSH_RETRIES; ++attempt) {
+    if (attempt > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::vector<Flush> writes_of;
+    std::vector<Flush> still_busy;
+    for (auto &flush : busy) {
+      if (flush.instance_->frames_[flush.frame_id_].TryRLatch()) {
+        writes_of.push_back(flush);
+      } else {
+        still_busy.push_back(flush);
+      }
+    }
+    busy = std::move(still_busy);
+
+    // queue all the writes at once in page id order, the scheduler merges consecutive pages and spreads the runs over
+    // its workers
+    std::vector<DiskRequest> requests;
+    std::vector<std::future<bool>> writes;
+    for (auto &flush : writes_of) {
+      auto &page = flush.instance_->frames_[flush.frame_id_];
+      DiskRequest r;
+      r.is_write_ = true;
+      r.data_ = page.data_;
+      r.page_id_ = page.page_id_;
+      r.callback_ = disk_scheduler_->CreatePromise();
+      writes.emplace_back(r.callback_.get_future());
+      requests.emplace_back(std::move(r));
+    }
+    disk_scheduler_->Schedule(std::move(requests));
+    for (size_t i = 0; i < writes_of.size(); ++i) {
+      auto &page = writes_of[i].instance_->frames_[writes_of[i].frame_id_];
+      if (writes[i].get()) {
+        auto lock = LockInstance(*writes_of[i].instance_);
+        page.is_dirty_ = false;
+      }
+      page.RUnlatch();
+    }
+  }
+
+  for (auto &flush : flushes) {
+    auto lock = LockInstance(*flush.instance_);
+    if ((--flush.instance_->frames_[flush.frame_id_].pin_count_) == 0) {
+      flush.instance_->replacer_->SetEvictable(flush.frame_id_, true);
+    }
+  }
+}
+
+auto BufferPoolManager::SaveHotPages() -> size_t {
+  std::vector<std::vector<page_id_t>> instance_pages;
+  for (auto &instance : instances_) {
+    auto lock = LockInstance(*instance);
+    auto &pages = instance_pages.emplace_back();
+    for (auto &[page_id, fid] : instance->page_table_) {
+      if (instance->frames_[fid].pin_count_ > 0) {
+        pages.push_back(page_id);
+      }
+    }
+    auto victims = instance->replacer_->EvictionCandidates(instance->size_);
+    for (auto it = victims.rbegin(); it != victims.rend(); ++it) {
+      pages.push_back(instance->frames_[*it].page_id_);
+    }
+  }
+
+  // the instances are equally hot, their lists are interleaved
+  std::vector<page_id_t> hot_pages;
+  for (size_t rank = 0; hot_pages.size() < pool_size_; ++rank) {
+    size_t size = hot_pages.size();
+    for (auto &pages : instance_pages) {
+      if (rank < pages.size()) {
+        hot_pages.push_back(pages[rank]);
+      }
+    }
+    if (hot_pages.size() == size) {
+      break;
+    }
+  }
+  disk_manager_->WriteHotPages(hot_pages);
+  return hot_pages.size();
+}
+
+auto BufferPoolManager::WarmUp(size_t max_pages, std::chrono::milliseconds budget) -> size_t {
+  auto deadline = std::chrono::steady_clock::now() + budget;
+  page_id_t num_pages = disk_manager_->GetNumPages();
+
+  struct Reload {
+    page_id_t page_id_;
+    BufferPoolInstance *instance_;
+    frame_id_t frame_id_;
+    bool loaded_;
+  };
+
+  // reserve a free frame for every page of the list, the hottest first; warming up never evicts anything
+  std::vector<Reload> reloads;
+  for (page_id_t page_id : disk_manager_->ReadHotPages(std::min(max_pages, pool_size_))) {
+    if (page_id < 0 || page_id >= num_pages) {
+      continue;
+    }
+    auto &instance = InstanceOf(page_id);
+    auto lock = LockInstance(instance);
+    if (instance.free_list_.empty() || instance.page_table_.count(page_id) > 0 ||
+        instance.free_pages_.count(page_id) > 0) {
+      continue;
+    }
+    frame_id_t fid = instance.free_list_.front();
+    instance.free_list_.pop_front();
+    auto &page = instance.frames_[fid];
+    instance.page_table_.insert({page_id, fid});
+    page.pin_count_ = 1;
+    page.page_id_ = page_id;
+    instance.frame_states_[fid] = FrameState::Loading;
+    reloads.push_back({page_id, &instance, fid, false});
+  }
+
+  // read the pages in file order, a run of consecutive pages with a single request, until the time is up
+  std::vector<Reload *> sorted;
+  sorted.reserve(reloads.size());
+  for (auto &reload : reloads) {
+    sorted.push_back(&reload);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](auto *a, auto *b) { return a->page_id_ < b->page_id_; });
+  for (size_t begin = 0; begin < sorted.size() && std::chrono::steady_clock::now() < deadline;) {
+    size_t end = begin + 1;
+    while (end < sorted.size() && sorted[end]->page_id_ == sorted[end - 1]->page_id_ + 1) {
+      end++;
+    }
+    std::vector<char *> run;
+    for (size_t i = begin; i < end; ++i) {
+      run.push_back(sorted[i]->instance_->frames_[sorted[i]->frame_id_].data_);
+      sorted[i]->loaded_ = true;
+    }
+    auto start = std::chrono::steady_clock::now();
+    disk_manager_->ReadPages(sorted[begin]->page_id_, run);
+    stats_.disk_read_latency_.Record(std::chrono::steady_clock::now() - start);
+    begin = end;
+  }
+
+  // the coldest pages go to the replacers first, so that they are evicted first too
+  size_t loaded = 0;
+  for (auto it = reloads.rbegin(); it != reloads.rend(); ++it) {
+    auto &instance = *it->instance_;
+    auto lock = LockInstance(instance);
+    auto &page = instance.frames_[it->frame_id_];
+    if (!it->loaded_ && page.pin_count_ == 1) {
+      // out of time, and nobody is waiting for the page
+      instance.page_table_.erase(it->page_id_);
+      page.pin_count_ = 0;
+      page.page_id_ = INVALID_PAGE_ID;
+      instance.frame_states_[it->frame_id_] = FrameState::Ready;
+      instance.free_list_.push_back(it->frame_id_);
+      continue;
+    }
+    if (!it->loaded_) {
+      lock.unlock();
+      disk_manager_->ReadPage(it->page_id_, page.data_);
+      lock.lock();
+    }
+    loaded++;
+    instance.replacer_->RecordAccess(it->frame_id_, AccessType::Unknown, it->page_id_);
+    instance.frame_states_[it->frame_id_] = FrameState::Ready;
+    if ((--page.pin_count_) == 0) {
+      instance.replacer_->SetEvictable(it->frame_id_, true);
+    }
+    instance.io_done_[it->frame_id_].notify_all();
+  }
+  return loaded;
 }
 
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> l(latch_);
+  if (page_id < 0) {
+    // never allocated, there is nothing to delete
+    return true;
+  }
+  if (disk_manager_->IsReadOnly()) {
+    return false;
+  }
+  auto &instance = InstanceOf(page_id);
+  auto lock = LockInstance(instance);
+  // a pending write back must not land after the page is gone
+  WaitForWriteBack(instance, lock, page_id);
 
-  if (page_table_.count(page_id) == 0U) {
+  auto it = instance.page_table_.find(page_id);
+  if (it == instance.page_table_.end()) {
+    DeallocatePage(page_id);
     return true;
   }
 
-  frame_id_t fid = page_table_[page_id];
+  frame_id_t fid = it->second;
+  auto &page = instance.frames_[fid];
 
-  if (pages_[fid].GetPinCount() == 0) {
-    page_table_.erase(page_id);
-    free_list_.push_back(fid);
-    pages_[fid].ResetMemory();
-    pages_[fid].page_id_ = INVALID_PAGE_ID;
-    pages_[fid].is_dirty_ = false;
+  if (page.GetPinCount() == 0) {
+    if (instance.prefetched_[fid]) {
+      instance.prefetched_[fid] = false;
+      stats_.prefetch_wasted_++;
+    }
+    instance.page_table_.erase(it);
+    LeaveProbation(instance, fid);
+    instance.free_list_.push_back(fid);
+    page.ResetMemory();
+    page.page_id_ = INVALID_PAGE_ID;
+    page.is_dirty_ = false;
     DeallocatePage(page_id);
-    replacer_->Remove(fid);
+    instance.replacer_->Remove(fid);
     return true;
   }
 
   return false;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManager::AllocatePage(BufferPoolInstance &instance, PageExtent *extent, page_id_t *new_extent_page_id)
+    -> page_id_t {
+  *new_extent_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = INVALID_PAGE_ID;
+  // a table or index fills its extent first, so that its pages stay contiguous
+  if (extent == &instance.extent_ || extent->IsEmpty()) {
+    // the lowest free page keeps the file compact, but a stale reader may have fetched a free page back in
+    for (auto it = instance.free_pages_.begin(); it != instance.free_pages_.end(); ++it) {
+      if (instance.page_table_.count(*it) == 0 && instance.write_back_table_.count(*it) == 0) {
+        page_id = *it;
+        instance.free_pages_.erase(it);
+        break;
+      }
+    }
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    if (extent->IsEmpty()) {
+      extent->next_page_id_ = instance.next_extent_page_id_;
+      extent->end_page_id_ = instance.next_extent_page_id_ + BUFFER_POOL_EXTENT_SIZE;
+      instance.next_extent_page_id_ += static_cast<page_id_t>(instances_.size()) * BUFFER_POOL_EXTENT_SIZE;
+      *new_extent_page_id = extent->next_page_id_;
+      // the pages of the extent count as free until they are handed out, so that a restart, which forgets the extent,
+      // finds the ones it never handed out in the free page map and reuses them
+      disk_manager_->SetPagesFree(extent->next_page_id_, BUFFER_POOL_EXTENT_SIZE);
+    }
+    page_id = extent->next_page_id_++;
+  }
+  // clears the page in the free page map, whether it was deallocated before or is new in its extent; the map is only
+  // changed in memory here, the disk manager writes it at the next sync
+  disk_manager_->SetPageFree(page_id, false);
+  return page_id;
+}
+
+void BufferPoolManager::DeallocatePage(page_id_t page_id) {
+  auto &instance = InstanceOf(page_id);
+  // the rest of the extent of the instance is handed out later, deallocating it would hand it out twice
+  const auto &extent = instance.extent_;
+  bool in_extent = page_id >= extent.next_page_id_ && page_id < extent.end_page_id_;
+  if (page_id < 0 || page_id >= instance.next_extent_page_id_ || in_extent ||
+      !instance.free_pages_.insert(page_id).second) {
+    // never allocated, or deallocated already
+    return;
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  disk_manager_->SetPageFree(page_id, true);
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
   // std::scoped_lock<std::mutex> l(latch_);
 
-  return {this, FetchPage(page_id)};
+  return {this, FetchPage(page_id, access_type)};
 }
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
+auto BufferPoolManager::FetchPagesBasic(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<BasicPageGuard> {
+  std::vector<BasicPageGuard> guards;
+  for (auto *page : FetchFrames(page_ids, access_type)) {
+    guards.emplace_back(this, page);
+  }
+  return guards;
+}
+
+auto BufferPoolManager::FetchPagesRead(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<ReadPageGuard> {
+  std::vector<ReadPageGuard> guards;
+  // the pages are latched in page id order, like any other batch
+  for (auto *page : FetchFrames(page_ids, access_type)) {
+    page->RLatch();
+    guards.emplace_back(this, page);
+  }
+  return guards;
+}
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
   // std::scoped_lock<std::mutex> l(latch_);
-  auto *page = FetchPage(page_id);
+  auto *page = FetchPage(page_id, access_type);
   if (page == nullptr) {
     return {this, nullptr};
   }
@@ -202,9 +1276,9 @@ auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
   return {this, page};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
   // std::scoped_lock<std::mutex> l(latch_);
-  auto *page = FetchPage(page_id);
+  auto *page = FetchPage(page_id, access_type);
   if (page == nullptr) {
     return {this, nullptr};
   }
@@ -214,10 +1288,14 @@ auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
   return {this, page};
 }
 
-auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type) -> OptimisticReadGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
+auto BufferPoolManager::NewPageGuarded(page_id_t *page_id, PageExtent *extent) -> BasicPageGuard {
   // std::scoped_lock<std::mutex> l(latch_);
 
-  return {this, NewPage(page_id)};
+  return {this, NewPage(page_id, extent)};
 }
 
 }  // namespace bustub
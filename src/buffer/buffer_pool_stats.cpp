@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto BufferPoolStats::Describe() const -> std::vector<std::pair<std::string, std::string>> {
+  std::vector<std::pair<std::string, std::string>> rows;
+  const char *access_type_names[NUM_ACCESS_TYPES] = {"unknown", "get", "scan"};
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+    rows.emplace_back(fmt::format("fetch.{}", access_type_names[i]),
+                      fmt::format("hits={} misses={} hit_rate={:.4f}", fetch_hits_[i].load(), fetch_misses_[i].load(),
+                                  HitRate(static_cast<AccessType>(i))));
+  }
+  rows.emplace_back("evictions", std::to_string(evictions_.load()));
+  rows.emplace_back("dirty_evictions", std::to_string(dirty_evictions_.load()));
+  rows.emplace_back("cleaner_writes", std::to_string(cleaner_writes_.load()));
+  rows.emplace_back("pin_failures", std::to_string(pin_failures_.load()));
+  rows.emplace_back("prefetch", fmt::format("issued={} hits={} wasted={}", prefetch_issued_.load(),
+                                            prefetch_hits_.load(), prefetch_wasted_.load()));
+  rows.emplace_back("admission", fmt::format("rejects={} promotions={}", admission_rejects_.load(),
+                                             admission_promotions_.load()));
+  rows.emplace_back("compressed_cache",
+                    fmt::format("hits={} misses={} hit_rate={:.4f} stores={} ratio={:.2f}", compressed_hits_.load(),
+                                compressed_misses_.load(), CompressedHitRate(), compressed_stores_.load(),
+                                compressed_bytes_ == 0 ? 0.0
+                                                       : static_cast<double>(compressed_stores_ * BUSTUB_PAGE_SIZE) /
+                                                             static_cast<double>(compressed_bytes_)));
+  rows.emplace_back("latch_waits",
+                    fmt::format("count={} total={:.3f}ms", latch_waits_.load(), latch_wait_ns_.load() / 1e6));
+  rows.emplace_back("fetch_latency", fetch_latency_.ToString());
+  rows.emplace_back("disk_read_latency", disk_read_latency_.ToString());
+  return rows;
+}
+
+}  // namespace bustub
@@ -14,16 +14,105 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_frames_(num_pages),
+      tracked_(new std::atomic<bool>[num_pages]),
+      referenced_(new std::atomic<bool>[num_pages]),
+      evictable_(num_pages, false) {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    tracked_[i] = false;
+    referenced_[i] = false;
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> l(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+  // within two turns of the hand, every reference bit of an evictable frame has been cleared
+  for (size_t step = 0; step < 2 * num_frames_ + 1; ++step) {
+    size_t fid = hand_;
+    hand_ = (hand_ + 1) % num_frames_;
+    if (!tracked_[fid] || !evictable_[fid]) {
+      continue;
+    }
+    if (referenced_[fid].exchange(false)) {
+      continue;
+    }
+    tracked_[fid] = false;
+    evictable_[fid] = false;
+    curr_size_--;
+    *frame_id = static_cast<frame_id_t>(fid);
+    return true;
+  }
+  return false;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> l(latch_);
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+  // frames with a clear reference bit go in this turn of the hand, the others in the next one
+  std::vector<frame_id_t> candidates;
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < num_frames_ && candidates.size() < max_count; ++i) {
+      size_t fid = (hand_ + i) % num_frames_;
+      if (tracked_[fid] && evictable_[fid] && referenced_[fid] == referenced) {
+        candidates.push_back(static_cast<frame_id_t>(fid));
+      }
+    }
+  }
+  return candidates;
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < num_frames_ && frame_id >= 0, "frame id out of replacer size");
+
+  bool reference = access_type != AccessType::Scan;
+  if (tracked_[frame_id]) {
+    if (reference) {
+      referenced_[frame_id] = true;
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> l(latch_);
+  referenced_[frame_id] = reference;
+  tracked_[frame_id] = true;
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> l(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < num_frames_ && frame_id >= 0, "frame id out of replacer size");
+
+  if (!tracked_[frame_id] || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> l(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < num_frames_ && frame_id >= 0, "frame id out of replacer size");
+
+  if (!tracked_[frame_id]) {
+    return;
+  }
+  BUSTUB_ASSERT(evictable_[frame_id], "cannot remove a pinned frame");
+  tracked_[frame_id] = false;
+  evictable_[frame_id] = false;
+  referenced_[frame_id] = false;
+  curr_size_--;
+}
+
+auto ClockReplacer::Size() -> size_t { return curr_size_; }
 
 }  // namespace bustub
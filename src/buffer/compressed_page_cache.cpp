@@ -0,0 +1,252 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** Shortest match worth encoding. */
+constexpr size_t MIN_MATCH = 4;
+/** Matches are looked up by the hash of their first MIN_MATCH bytes, in a table of 2^HASH_BITS slots. */
+constexpr size_t HASH_BITS = 12;
+/** Lengths of literal runs and matches are stored in a nibble of the token, and continued in extra bytes. */
+constexpr size_t NIBBLE_MAX = 15;
+
+auto Read32(const char *p) -> uint32_t {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+auto Hash(uint32_t v) -> size_t { return (v * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Append the continuation bytes of a length that does not fit into its nibble. */
+auto PutLength(size_t length, char *out, size_t *op, size_t out_capacity) -> bool {
+  for (; length >= 255; length -= 255) {
+    if (*op >= out_capacity) {
+      return false;
+    }
+    out[(*op)++] = static_cast<char>(255);
+  }
+  if (*op >= out_capacity) {
+    return false;
+  }
+  out[(*op)++] = static_cast<char>(length);
+  return true;
+}
+
+/** Read the continuation bytes of a length whose nibble is saturated. */
+auto GetLength(const char *in, size_t in_size, size_t *ip, size_t *length) -> bool {
+  uint8_t byte;
+  do {
+    if (*ip >= in_size) {
+      return false;
+    }
+    byte = static_cast<uint8_t>(in[(*ip)++]);
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/**
+ * Append a sequence: a token holding both lengths, the literals, and the match as a 2 byte offset back into the output.
+ * The last sequence of a page has literals only.
+ */
+auto PutSequence(const char *literals, size_t literal_length, size_t offset, size_t match_length, char *out, size_t *op,
+                 size_t out_capacity) -> bool {
+  if (*op >= out_capacity) {
+    return false;
+  }
+  size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+  out[(*op)++] = static_cast<char>((std::min(literal_length, NIBBLE_MAX) << 4) | std::min(match_code, NIBBLE_MAX));
+  if (literal_length >= NIBBLE_MAX && !PutLength(literal_length - NIBBLE_MAX, out, op, out_capacity)) {
+    return false;
+  }
+  if (*op + literal_length > out_capacity) {
+    return false;
+  }
+  memcpy(out + *op, literals, literal_length);
+  *op += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+
+  if (*op + 2 > out_capacity) {
+    return false;
+  }
+  out[(*op)++] = static_cast<char>(offset & 0xff);
+  out[(*op)++] = static_cast<char>(offset >> 8);
+  if (match_code >= NIBBLE_MAX && !PutLength(match_code - NIBBLE_MAX, out, op, out_capacity)) {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+auto CompressedPageCache::Compress(const char *page_data, char *out, size_t out_capacity) -> size_t {
+  static_assert(BUSTUB_PAGE_SIZE <= 65536, "match offsets are stored in 2 bytes");
+  std::array<int32_t, 1 << HASH_BITS> table;
+  table.fill(-1);
+
+  size_t ip = 0;
+  size_t anchor = 0;
+  size_t op = 0;
+  while (ip + MIN_MATCH <= BUSTUB_PAGE_SIZE) {
+    uint32_t sequence = Read32(page_data + ip);
+    size_t h = Hash(sequence);
+    int32_t candidate = table[h];
+    table[h] = static_cast<int32_t>(ip);
+    if (candidate < 0 || Read32(page_data + candidate) != sequence) {
+      ip++;
+      continue;
+    }
+
+    auto match = static_cast<size_t>(candidate);
+    size_t length = MIN_MATCH;
+    while (ip + length < BUSTUB_PAGE_SIZE && page_data[match + length] == page_data[ip + length]) {
+      length++;
+    }
+    if (!PutSequence(page_data + anchor, ip - anchor, ip - match, length, out, &op, out_capacity)) {
+      return 0;
+    }
+    ip += length;
+    anchor = ip;
+  }
+
+  if (!PutSequence(page_data + anchor, BUSTUB_PAGE_SIZE - anchor, 0, 0, out, &op, out_capacity)) {
+    return 0;
+  }
+  return op;
+}
+
+auto CompressedPageCache::Decompress(const char *in, size_t in_size, char *page_data) -> bool {
+  size_t ip = 0;
+  size_t op = 0;
+  while (ip < in_size) {
+    auto token = static_cast<uint8_t>(in[ip++]);
+    size_t literal_length = token >> 4;
+    if (literal_length == NIBBLE_MAX && !GetLength(in, in_size, &ip, &literal_length)) {
+      return false;
+    }
+    if (ip + literal_length > in_size || op + literal_length > BUSTUB_PAGE_SIZE) {
+      return false;
+    }
+    memcpy(page_data + op, in + ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == in_size) {
+      break;
+    }
+
+    if (ip + 2 > in_size) {
+      return false;
+    }
+    size_t offset = static_cast<uint8_t>(in[ip]) | (static_cast<size_t>(static_cast<uint8_t>(in[ip + 1])) << 8);
+    ip += 2;
+    size_t match_length = token & NIBBLE_MAX;
+    if (match_length == NIBBLE_MAX && !GetLength(in, in_size, &ip, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || op + match_length > BUSTUB_PAGE_SIZE) {
+      return false;
+    }
+    // a match may overlap its own output, e.g. a run of zeros refers to the byte right before it
+    for (size_t i = 0; i < match_length; ++i) {
+      page_data[op + i] = page_data[op - offset + i];
+    }
+    op += match_length;
+  }
+  return op == BUSTUB_PAGE_SIZE;
+}
+
+auto CompressedPageCache::Put(page_id_t page_id, const char *page_data) -> size_t {
+  Entry entry{page_id, std::string(BUSTUB_PAGE_SIZE, '\0'), true};
+  size_t size = Compress(page_data, entry.data_.data(), BUSTUB_PAGE_SIZE);
+  if (size == 0) {
+    entry.compressed_ = false;
+    memcpy(entry.data_.data(), page_data, BUSTUB_PAGE_SIZE);
+  } else {
+    entry.data_.resize(size);
+    entry.data_.shrink_to_fit();
+  }
+  size_t bytes = entry.data_.size() + ENTRY_OVERHEAD;
+
+  std::scoped_lock l(latch_);
+  if (auto it = index_.find(page_id); it != index_.end()) {
+    EraseEntry(it->second);
+  }
+  if (bytes > capacity_) {
+    return 0;
+  }
+  while (used_bytes_ + bytes > capacity_) {
+    EraseEntry(entries_.begin());
+  }
+  used_bytes_ += bytes;
+  entries_.push_back(std::move(entry));
+  index_.emplace(page_id, std::prev(entries_.end()));
+  return bytes - ENTRY_OVERHEAD;
+}
+
+auto CompressedPageCache::Take(page_id_t page_id, char *page_data) -> bool {
+  Entry entry;
+  {
+    std::scoped_lock l(latch_);
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    entry = std::move(*it->second);
+    used_bytes_ -= entry.data_.size() + ENTRY_OVERHEAD;
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  if (!entry.compressed_) {
+    memcpy(page_data, entry.data_.data(), BUSTUB_PAGE_SIZE);
+    return true;
+  }
+  return Decompress(entry.data_.data(), entry.data_.size(), page_data);
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::scoped_lock l(latch_);
+  if (auto it = index_.find(page_id); it != index_.end()) {
+    EraseEntry(it->second);
+  }
+}
+
+auto CompressedPageCache::Size() -> size_t {
+  std::scoped_lock l(latch_);
+  return entries_.size();
+}
+
+auto CompressedPageCache::UsedBytes() -> size_t {
+  std::scoped_lock l(latch_);
+  return used_bytes_;
+}
+
+void CompressedPageCache::EraseEntry(std::list<Entry>::iterator it) {
+  used_bytes_ -= it->data_.size() + ENTRY_OVERHEAD;
+  index_.erase(it->page_id_);
+  entries_.erase(it);
+}
+
+}  // namespace bustub
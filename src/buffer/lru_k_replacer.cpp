@@ -15,74 +15,67 @@
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {
-  // curr_timestamp_ =
-  //   std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : node_store_(num_frames), replacer_size_(num_frames), k_(k) {}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::lock_guard<std::mutex> l(latch_);
 
-  frame_id_t fid;
-  bool evicted = false;
+  // frames only seen by scans go first, then frames with +inf backward k-distance, the earliest accessed one among them
+  auto &eviction_set = !scan_set_.empty() ? scan_set_ : !hist_set_.empty() ? hist_set_ : cache_set_;
+  if (eviction_set.empty()) {
+    return false;
+  }
 
-  if (!hist_list_.empty()) {
-    auto it = std::find_if(hist_list_.begin(), hist_list_.end(),
-                           [this](const auto &x) { return node_store_[x].is_evictable_; });
+  frame_id_t fid = eviction_set.begin()->second;
+  eviction_set.erase(eviction_set.begin());
+  node_store_[fid] = LRUKNode();
+  curr_size_--;
+  *frame_id = fid;
+  return true;
+}
 
-    if (it != hist_list_.end()) {
-      fid = *it;
-      *frame_id = fid;
-      hist_list_.erase(it);
-      node_store_.erase(fid);
-      curr_size_--;
-      evicted = true;
-    }
-  }
-  if (!evicted && !cache_list_.empty()) {
-    auto it = std::find_if(cache_list_.begin(), cache_list_.end(),
-                           [this](const auto &x) { return node_store_[x].is_evictable_; });
-
-    if (it != cache_list_.end()) {
-      fid = *it;
-      *frame_id = fid;
-      cache_list_.erase(it);
-      node_store_.erase(fid);
-      curr_size_--;
-      evicted = true;
+auto LRUKReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> l(latch_);
+
+  std::vector<frame_id_t> candidates;
+  for (auto *eviction_set : {&scan_set_, &hist_set_, &cache_set_}) {
+    for (auto it = eviction_set->begin(); it != eviction_set->end() && candidates.size() < max_count; ++it) {
+      candidates.push_back(it->second);
     }
   }
-
-  return evicted;
+  return candidates;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
   std::lock_guard<std::mutex> l(latch_);
   BUSTUB_ASSERT((((size_t)(frame_id)) < replacer_size_ && frame_id >= 0), "frame id out of replacer size");
 
-  if (node_store_.count(frame_id) == 0U) {  // 首次访问
-    auto lruk_node = LRUKNode(1);
-    node_store_.insert({frame_id, lruk_node});
+  auto &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  // a scan must not promote a frame of the working set
+  if (is_scan && node.IsTracked() && !node.scan_only_) {
+    return;
+  }
 
-    hist_list_.push_back(frame_id);
-  } else {
-    size_t new_access_cnt = ++node_store_[frame_id].access_cnt_;
-    frame_id_t fid;
-    if (new_access_cnt == k_) {
-      auto it =
-          std::find_if(hist_list_.begin(), hist_list_.end(), [&frame_id](const auto &x) { return x == frame_id; });
-      fid = *it;
-
-      hist_list_.erase(it);
-      cache_list_.push_back(fid);
-    } else if (new_access_cnt > k_) {
-      auto it =
-          std::find_if(cache_list_.begin(), cache_list_.end(), [&frame_id](const auto &x) { return x == frame_id; });
-      fid = *it;
-
-      cache_list_.erase(it);
-      cache_list_.push_back(fid);
-    }
+  // an evictable frame changes its position (and possibly its set), a pinned one only its history
+  if (node.is_evictable_) {
+    EvictionSetOf(node).erase({node.Key(), frame_id});
+  }
+
+  if (is_scan || node.scan_only_) {
+    // frames in the scan ring only remember their latest access, and leave the ring with a fresh history
+    node.history_.clear();
+    node.access_cnt_ = 0;
+    node.scan_only_ = is_scan;
+  }
+  node.history_.push_back(current_timestamp_++);
+  if (node.history_.size() > k_) {
+    node.history_.pop_front();
+  }
+  node.access_cnt_ = std::min(node.access_cnt_ + 1, k_);
+
+  if (node.is_evictable_) {
+    EvictionSetOf(node).insert({node.Key(), frame_id});
   }
 }
 
@@ -90,38 +83,35 @@ void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::lock_guard<std::mutex> l(latch_);
   BUSTUB_ASSERT((((size_t)(frame_id)) < replacer_size_ && frame_id >= 0), "frame id out of replacer size");
 
-  if (node_store_.count(frame_id) == 0U) {
+  auto &node = node_store_[frame_id];
+  if (!node.IsTracked() || node.is_evictable_ == set_evictable) {
     return;
   }
 
-  bool pre_evictable = node_store_[frame_id].is_evictable_;
-  if (pre_evictable && !set_evictable) {
-    curr_size_--;
-  } else if (!pre_evictable && set_evictable) {
+  if (set_evictable) {
+    EvictionSetOf(node).insert({node.Key(), frame_id});
     curr_size_++;
+  } else {
+    EvictionSetOf(node).erase({node.Key(), frame_id});
+    curr_size_--;
   }
-  node_store_[frame_id].is_evictable_ = set_evictable;
+  node.is_evictable_ = set_evictable;
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::lock_guard<std::mutex> l(latch_);
   BUSTUB_ASSERT((((size_t)(frame_id)) < replacer_size_ && frame_id >= 0), "frame id out of replacer size");
 
-  if (node_store_.count(frame_id) == 0U) {
+  auto &node = node_store_[frame_id];
+  if (!node.IsTracked()) {
     return;
   }
 
-  BUSTUB_ASSERT((node_store_[frame_id].is_evictable_), "remove frame falled");
-
-  if (node_store_[frame_id].access_cnt_ >= k_) {
-    cache_list_.remove_if([&frame_id](const auto &x) { return frame_id == x; });
-  } else {
-    hist_list_.remove_if([&frame_id](const auto &x) { return frame_id == x; });
-  }
+  BUSTUB_ASSERT((node.is_evictable_), "remove frame falled");
 
-  if (node_store_.erase(frame_id) > 0) {
-    curr_size_--;
-  }
+  EvictionSetOf(node).erase({node.Key(), frame_id});
+  node = LRUKNode();
+  curr_size_--;
 }
 
 auto LRUKReplacer::Size() -> size_t { return curr_size_; }
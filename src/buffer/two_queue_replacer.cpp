@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : node_store_(num_frames), kin_(std::max<size_t>(1, num_frames / 4)), kout_(std::max<size_t>(1, num_frames / 2)) {}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> l(latch_);
+
+  auto &eviction_set = EvictFromA1in() ? a1in_set_ : am_set_;
+  if (eviction_set.empty()) {
+    return false;
+  }
+
+  frame_id_t fid = eviction_set.begin()->second;
+  eviction_set.erase(eviction_set.begin());
+  auto &node = node_store_[fid];
+  if (node.queue_ == Queue::A1in) {
+    a1in_size_--;
+    if (node.page_id_ != INVALID_PAGE_ID) {
+      a1out_.Push(node.page_id_);
+      if (a1out_.Size() > kout_) {
+        a1out_.PopOldest();
+      }
+    }
+  }
+  node = TwoQueueNode();
+  curr_size_--;
+  *frame_id = fid;
+  return true;
+}
+
+auto TwoQueueReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> l(latch_);
+
+  std::vector<frame_id_t> candidates;
+  auto order = EvictFromA1in() ? std::make_pair(&a1in_set_, &am_set_) : std::make_pair(&am_set_, &a1in_set_);
+  for (auto *eviction_set : {order.first, order.second}) {
+    for (auto it = eviction_set->begin(); it != eviction_set->end() && candidates.size() < max_count; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::lock_guard<std::mutex> l(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < node_store_.size() && frame_id >= 0, "frame id out of replacer size");
+
+  auto &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (node.queue_ == Queue::None) {
+    // a page that comes back while it is still remembered in A1out is hot
+    bool hot = !is_scan && page_id != INVALID_PAGE_ID && a1out_.Erase(page_id);
+    node.queue_ = hot ? Queue::Am : Queue::A1in;
+    if (!hot) {
+      a1in_size_++;
+    }
+    node.key_ = current_timestamp_++;
+    node.page_id_ = page_id;
+    return;
+  }
+
+  // accesses in A1in are correlated with the first one, only Am is kept in LRU order
+  if (node.queue_ == Queue::Am && !is_scan) {
+    if (node.is_evictable_) {
+      am_set_.erase({node.key_, frame_id});
+    }
+    node.key_ = current_timestamp_++;
+    if (node.is_evictable_) {
+      am_set_.insert({node.key_, frame_id});
+    }
+  }
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> l(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < node_store_.size() && frame_id >= 0, "frame id out of replacer size");
+
+  auto &node = node_store_[frame_id];
+  if (node.queue_ == Queue::None || node.is_evictable_ == set_evictable) {
+    return;
+  }
+
+  if (set_evictable) {
+    EvictionSetOf(node).insert({node.key_, frame_id});
+    curr_size_++;
+  } else {
+    EvictionSetOf(node).erase({node.key_, frame_id});
+    curr_size_--;
+  }
+  node.is_evictable_ = set_evictable;
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> l(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < node_store_.size() && frame_id >= 0, "frame id out of replacer size");
+
+  auto &node = node_store_[frame_id];
+  if (node.queue_ == Queue::None) {
+    return;
+  }
+  BUSTUB_ASSERT(node.is_evictable_, "cannot remove a pinned frame");
+
+  EvictionSetOf(node).erase({node.key_, frame_id});
+  if (node.queue_ == Queue::A1in) {
+    a1in_size_--;
+  }
+  node = TwoQueueNode();
+  curr_size_--;
+}
+
+auto TwoQueueReplacer::Size() -> size_t { return curr_size_; }
+
+}  // namespace bustub
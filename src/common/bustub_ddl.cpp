@@ -72,9 +72,16 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
   }
 
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
-      IntegerHashFunctionType{});
+  IndexInfo *info;
+  if (IntegerComparatorType::CanCompare(&key_schema)) {
+    info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+        txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
+        IntegerHashFunctionType{});
+  } else {
+    info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, GenericComparatorType>(
+        txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
+        IntegerHashFunctionType{});
+  }
   l.unlock();
 
   if (info == nullptr) {
@@ -128,11 +135,23 @@ void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainState
 void BustubInstance::HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt,
                                                  ResultWriter &writer) {
   auto content = GetSessionVariable(stmt.variable_);
+  if (stmt.variable_ == "buffer_pool_replacer" && buffer_pool_manager_ != nullptr) {
+    content = ReplacerPolicyToString(buffer_pool_manager_->GetReplacerPolicy());
+  }
   WriteOneCell(fmt::format("{}={}", stmt.variable_, content), writer);
 }
 
 void BustubInstance::HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt,
                                                 ResultWriter &writer) {
+  if (stmt.variable_ == "buffer_pool_replacer") {
+    ReplacerPolicy policy;
+    if (!ParseReplacerPolicy(stmt.value_, &policy)) {
+      throw bustub::Exception(fmt::format("unknown replacer {}, expected lru-k, lru, clock, 2q or arc", stmt.value_));
+    }
+    if (buffer_pool_manager_ != nullptr) {
+      buffer_pool_manager_->SetReplacerPolicy(policy);
+    }
+  }
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
@@ -11,6 +11,11 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+#include <variant>
+
+#include "storage/page/table_page.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
@@ -19,36 +24,79 @@ void IndexScanExecutor::Init() {
   Catalog *catalog = exec_ctx_->GetCatalog();
   index_info_ = catalog->GetIndex(plan_->GetIndexOid());
   table_info_ = catalog->GetTable(index_info_->table_name_);
-  auto *tree = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info_->index_.get());
-  iter_ = tree->GetBeginIterator();
+  if (auto *tree = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info_->index_.get()); tree != nullptr) {
+    iter_ = MakeIterator(tree);
+  } else {
+    iter_ = MakeIterator(dynamic_cast<BPlusTreeIndexForTwoColumn *>(index_info_->index_.get()));
+  }
+  guards_.clear();
+  batch_.clear();
+  batch_pos_ = 0;
 }
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (iter_.IsEnd()) {
-    return false;
+template <class Tree>
+auto IndexScanExecutor::MakeIterator(Tree *tree) const -> decltype(tree->GetBeginIterator()) {
+  if (!plan_->lower_.has_value() && !plan_->upper_.has_value() && !plan_->reverse_) {
+    return tree->GetBeginIterator();
   }
+  return tree->GetRangeIterator(MakeBound(plan_->lower_), MakeBound(plan_->upper_), plan_->reverse_);
+}
 
-  auto pair = *iter_;
-  *rid = pair.second;
-
-  auto tuple_pair = table_info_->table_->GetTuple(*rid);
+auto IndexScanExecutor::MakeBound(const std::optional<IndexScanBound> &bound) const
+    -> std::optional<IndexKeyBound<IntegerKeyType>> {
+  if (!bound.has_value()) {
+    return std::nullopt;
+  }
+  IndexKeyBound<IntegerKeyType> key_bound{{}, bound->inclusive_};
+  key_bound.key_.SetFromKey(Tuple({bound->value_}, &index_info_->key_schema_));
+  return key_bound;
+}
 
-  while (tuple_pair.first.is_deleted_) {
-    ++iter_;
-    if (iter_.IsEnd()) {
-      return false;
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (batch_pos_ < batch_.size() || FetchBatch()) {
+    *rid = batch_[batch_pos_++];
+    auto tuple_pair = GetTuple(*rid);
+    if (!tuple_pair.first.is_deleted_) {
+      *tuple = std::move(tuple_pair.second);
+      return true;
     }
-    pair = *iter_;
-    *rid = pair.second;
-
-    tuple_pair = table_info_->table_->GetTuple(*rid);
   }
+  return false;
+}
 
-  *tuple = tuple_pair.second;
+auto IndexScanExecutor::FetchBatch() -> bool {
+  // the pages of the previous batch are released first, they may be needed for this one
+  guards_.clear();
+  batch_.clear();
+  batch_pos_ = 0;
+  std::vector<page_id_t> page_ids;
+  std::visit(
+      [&](auto &iter) {
+        for (; !iter.IsEnd() && batch_.size() < static_cast<size_t>(INDEX_SCAN_BATCH_SIZE); ++iter) {
+          batch_.push_back((*iter).second);
+          page_ids.push_back(batch_.back().GetPageId());
+        }
+      },
+      iter_);
 
-  ++iter_;
+  // the pages stay pinned until the batch is consumed, so that its tuples are read without going through the buffer
+  // pool again
+  guards_ = exec_ctx_->GetBufferPoolManager()->FetchPagesBasic(page_ids);
+  return !batch_.empty();
+}
 
-  return true;
+auto IndexScanExecutor::GetTuple(const RID &rid) -> std::pair<TupleMeta, Tuple> {
+  auto it = std::lower_bound(guards_.begin(), guards_.end(), rid.GetPageId(),
+                             [](BasicPageGuard &guard, page_id_t page_id) { return guard.PageId() < page_id; });
+  if (it == guards_.end() || it->PageId() != rid.GetPageId()) {
+    // the batch was cut short, the buffer pool had no frame left for this page
+    return table_info_->table_->GetTuple(rid);
+  }
+  // the page is only latched while the tuple is copied out of it, the pin is kept for the next tuples of the batch
+  auto read_guard = it->UpgradeRead();
+  auto tuple_pair = read_guard.As<TablePage>()->GetTuple(rid);
+  *it = read_guard.Downgrade();
+  return tuple_pair;
 }
 
 }  // namespace bustub
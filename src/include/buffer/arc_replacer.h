@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo & Modha, FAST '03).
+ *
+ * Resident frames are split into T1, holding pages seen once recently, and T2, holding pages seen at least twice. Both
+ * are LRU lists. Pages evicted from T1 and T2 are remembered in the ghost lists B1 and B2. A miss on a page in B1
+ * means T1 is too small, a miss on a page in B2 means T2 is too small; either moves the target size p of T1 and brings
+ * the page into T2. Eviction takes from T1 while it is larger than p, and from T2 otherwise.
+ *
+ * Pinned frames stay in their list but are skipped by eviction. Scan accesses never move a page into T2.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  /** @return the current target size of T1 */
+  auto GetTarget() -> size_t {
+    std::lock_guard<std::mutex> l(latch_);
+    return p_;
+  }
+
+ private:
+  enum class List { None, T1, T2 };
+
+  struct ARCNode {
+    List list_{List::None};
+    /** The latest access to the frame. */
+    size_t key_{0};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    bool is_evictable_{false};
+  };
+
+  /** An evictable frame in an eviction set, ordered by ARCNode::key_. */
+  using EvictionEntry = std::pair<size_t, frame_id_t>;
+
+  auto EvictionSetOf(const ARCNode &node) -> std::set<EvictionEntry> & {
+    return node.list_ == List::T1 ? t1_set_ : t2_set_;
+  }
+
+  /** @return true if the next victim comes from T1 */
+  auto EvictFromT1() const -> bool { return !t1_set_.empty() && (t1_size_ > p_ || t2_set_.empty()); }
+
+  /** Forget the oldest ghosts, so that T1 + B1 stays within the capacity and all lists within twice of it. */
+  void TrimGhosts();
+
+  std::vector<ARCNode> node_store_;
+  /** Evictable frames of T1 and T2, the least recently used first. */
+  std::set<EvictionEntry> t1_set_;
+  std::set<EvictionEntry> t2_set_;
+  /** Pages recently evicted from T1 and T2. */
+  GhostList b1_;
+  GhostList b2_;
+  /** Number of frames in T1 and T2, pinned or not. */
+  size_t t1_size_{0};
+  size_t t2_size_{0};
+  /** Target size of T1, adapted on every ghost hit. */
+  size_t p_{0};
+  const size_t capacity_;
+  size_t current_timestamp_{0};
+  std::atomic<size_t> curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
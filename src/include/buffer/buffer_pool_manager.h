@@ -12,22 +12,92 @@
 
 #pragma once
 
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_k_replacer.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frequency_sketch.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/** Tunables of the background page cleaner of a BufferPoolManager. */
+struct PageCleanerOptions {
+  /** Share of the frames of every instance, in percent, that should be free or hold a clean page ready for eviction. */
+  size_t clean_target_percent_{PAGE_CLEANER_CLEAN_TARGET_PERCENT};
+  /** Maximum number of pages written back per instance in one round, which bounds the write rate of the cleaner. */
+  size_t max_writes_per_round_{PAGE_CLEANER_MAX_WRITES};
+  /** Time between two rounds. */
+  std::chrono::milliseconds interval_{PAGE_CLEANER_INTERVAL_MS};
+};
+
+/**
+ * A run of BUFFER_POOL_EXTENT_SIZE contiguous pages reserved for one table heap or index. The pages of the extent are
+ * handed out in order by NewPage(), so that consecutive pages of one owner are laid out next to each other in the file,
+ * instead of being interleaved with the pages of everything else that grows at the same time.
+ */
+struct PageExtent {
+  /** @return true if every page of the extent has been handed out, or no extent was reserved yet */
+  auto IsEmpty() const -> bool { return next_page_id_ == end_page_id_; }
+
+  /** The next page to hand out. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** One past the last page of the extent. */
+  page_id_t end_page_id_{INVALID_PAGE_ID};
+  /** Serializes the page creations of the owner. */
+  std::mutex latch_;
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * The buffer pool can be split into several independent instances. Each page id is owned by exactly one instance
+ * (`page_id / BUFFER_POOL_EXTENT_SIZE % num_instances`), and every instance has its own frames, page table, free list,
+ * replacer and latch, so that operations on pages owned by different instances never contend with each other.
+ *
+ * Disk I/O is never done while holding the latch of an instance. A frame that is being filled (or whose previous,
+ * dirty page is being written back) is pinned and marked with its state; the latch is only taken to update metadata.
+ * Threads that need a page which is in flight wait on the condition variable of that frame, while cache hits on other
+ * frames proceed. All I/O is issued through a DiskScheduler, so writes of FlushAllPages() run in parallel and runs of
+ * consecutive pages are written together.
+ *
+ * Scans over chains of pages (the pages of a table heap, the leaves of a B+ tree) can ask for the pages ahead of them
+ * to be read in the background with PrefetchChain(). Every fetch with AccessType::Scan is also passed on to
+ * DiskManager::AdviseScan(), for disk managers that read ahead on their own.
+ *
+ * Page ids are allocated in extents of BUFFER_POOL_EXTENT_SIZE contiguous pages, whose disk space is reserved in one
+ * go. An extent belongs to a single instance. Table heaps and indexes pass their own PageExtent to NewPage(), so that
+ * their pages are contiguous on disk; other pages come from the current extent of the instance that creates them.
+ *
+ * A page cleaner thread, once started with StartPageCleaner(), writes back dirty pages that are about to be evicted,
+ * so that evictions on the foreground path mostly find clean victims.
+ *
+ * If the disk manager does direct I/O, the data of all frames lives in one page aligned arena, optionally backed by
+ * huge pages, which reads and writes can use without a bounce buffer. The buffer pool is the only page cache then.
+ *
+ * Optionally, a CompressedPageCache keeps compressed copies of evicted pages as a second tier, which misses look into
+ * before going to disk. Pages are compressed as they are evicted, under the latch of their instance: that costs a few
+ * microseconds, which is well below the disk read it saves on a tier hit.
+ *
+ * Optionally, an admission filter in the style of TinyLFU keeps one-off reads of cold pages from evicting pages with
+ * long access histories. Every instance counts the accesses to its pages in a FrequencySketch. When a fetched page
+ * would evict a page that was accessed more often recently, it is only given a frame of a small probationary area
+ * instead, whose frames are kept free for it and then reused among the rejected pages. A rejected page that is fetched
+ * again leaves probation.
  */
 class BufferPoolManager {
  public:
@@ -37,9 +107,12 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the LookBack constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param num_instances the number of independent instances the frames are partitioned into
+   * @param replacer_policy the replacement policy of every instance
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t num_instances = 1,
+                    ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
@@ -52,6 +125,60 @@ class BufferPoolManager {
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return the number of independent instances the buffer pool is partitioned into. */
+  auto GetNumInstances() -> size_t { return instances_.size(); }
+
+  /** @brief Return the counters and latency histograms of the buffer pool. */
+  auto GetStats() -> const BufferPoolStats & { return stats_; }
+
+  /** @brief Return the replacement policy of the buffer pool. */
+  auto GetReplacerPolicy() -> ReplacerPolicy { return replacer_policy_; }
+
+  /**
+   * @brief Switch every instance over to a new replacement policy. The resident pages stay in place, but their access
+   * history starts over.
+   * @param replacer_policy the new replacement policy
+   */
+  void SetReplacerPolicy(ReplacerPolicy replacer_policy);
+
+  /** @brief Return the number of pages PrefetchChain() reads ahead of a scan. */
+  auto GetPrefetchDepth() -> size_t { return prefetch_depth_; }
+
+  /** @brief Set the number of pages PrefetchChain() reads ahead of a scan, 0 disables read-ahead. */
+  void SetPrefetchDepth(size_t prefetch_depth) { prefetch_depth_ = prefetch_depth; }
+
+  /** @brief Return whether the admission filter is enabled. */
+  auto HasAdmissionFilter() -> bool { return admission_filter_; }
+
+  /** @brief Enable or disable the admission filter in front of the replacers. */
+  void SetAdmissionFilter(bool admission_filter) { admission_filter_ = admission_filter; }
+
+  /** @brief Return the compressed cache behind the frames, or nullptr if there is none. */
+  auto GetCompressedCache() -> CompressedPageCache * { return compressed_cache_.get(); }
+
+  /**
+   * @brief Set up the compressed cache behind the frames, or drop it. Only call this while no other thread uses the
+   * buffer pool.
+   * @param capacity the memory the compressed pages may take in bytes, 0 for no compressed cache
+   */
+  void SetCompressedCacheSize(size_t capacity) {
+    compressed_cache_ = capacity == 0 ? nullptr : std::make_unique<CompressedPageCache>(capacity);
+  }
+
+  /**
+   * @brief Start the background page cleaner. Every round, the cleaner looks at the next eviction candidates of every
+   * instance and writes back the dirty ones, until enough frames are free or clean. With logging enabled, a page is
+   * only written once the log records up to its page_lsn are durable.
+   * @param options the targets and the write rate of the cleaner
+   */
+  void StartPageCleaner(const PageCleanerOptions &options = {});
+
+  /** @brief Stop the background page cleaner, if it is running. */
+  void StopPageCleaner();
+
+  /** Returns the id of the page following a page in its chain, given the page's data. */
+  using NextPageFn = page_id_t (*)(const char *page_data);
+
   /**
    * TODO(P1): Add implementation
    *
@@ -67,9 +194,12 @@ class BufferPoolManager {
    * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
    *
    * @param[out] page_id id of created page
-   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @param extent the extent of the table or index the page is created for, which hands out the next page of the
+   * extent, and reserves a new extent once it is used up and no deallocated page can be reused; nullptr to take any
+   * page
+   * @return nullptr if no new pages could be created, e.g. on a read-only disk manager, otherwise pointer to new page
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  auto NewPage(page_id_t *page_id, PageExtent *extent = nullptr) -> Page *;
 
   /**
    * TODO(P1): Add implementation
@@ -81,9 +211,10 @@ class BufferPoolManager {
    * BasicPageGuard structure.
    *
    * @param[out] page_id, the id of the new page
+   * @param extent the extent of the table or index the page is created for, or nullptr
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  auto NewPageGuarded(page_id_t *page_id, PageExtent *extent = nullptr) -> BasicPageGuard;
 
   /**
    * TODO(P1): Add implementation
@@ -117,9 +248,49 @@ class BufferPoolManager {
    * @param page_id the id of the page to fetch
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a batch of pages at once, e.g. the heap pages of the RIDs found by an index
+   *
+   * Every instance latch is taken once for the whole batch, duplicate ids are fetched once, and the pages that are not
+   * resident are read together in page id order, a run of consecutive pages with a single request. If the buffer pool
+   * runs out of frames, the batch is cut short: only the pages below the first one that could not be fetched are
+   * returned, and the caller may fetch the rest after releasing some of them.
+   *
+   * @param page_ids the ids of the pages to fetch
+   * @return guards of the distinct pages in page id order, possibly fewer than requested
+   */
+  auto FetchPagesBasic(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown)
+      -> std::vector<BasicPageGuard>;
+  auto FetchPagesRead(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown)
+      -> std::vector<ReadPageGuard>;
+
+  /**
+   * @brief Fetch a page for reading without latching it
+   *
+   * The returned guard only pins the page. Whatever is read through it has to be checked with
+   * OptimisticReadGuard::Validate() before it is trusted, since writers may change the page concurrently.
+   *
+   * @param page_id the id of the page to fetch
+   * @return an OptimisticReadGuard holding the fetched page, empty if the page cannot be fetched
+   */
+  auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> OptimisticReadGuard;
+
+  /**
+   * @brief Read the pages of a chain into the buffer pool in the background, ahead of a scan.
+   *
+   * Starting at page_id, up to GetPrefetchDepth() pages of the chain are made resident. Pages that are not in the buffer
+   * pool are read asynchronously one after another, since the next page of a chain is only known once its predecessor
+   * has been read. Read-ahead gives up early rather than waiting for anything, and it never pins more than a small
+   * share of the frames at once.
+   *
+   * @param page_id the first page of the chain the scan will visit
+   * @param next_page extracts the next page id of the chain from a page
+   */
+  void PrefetchChain(page_id_t page_id, NextPageFn next_page);
 
   /**
    * TODO(P1): Add implementation
@@ -146,21 +317,50 @@ class BufferPoolManager {
    * Unset the dirty flag of the page after flushing.
    *
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
-   * @return false if the page could not be found in the page table, true otherwise
+   * @return false if the page could not be found in the page table or could not be written, in which case it stays
+   * dirty, true otherwise
    */
   auto FlushPage(page_id_t page_id) -> bool;
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk, and sync the disk so that they are durable.
+   *
+   * Only dirty pages are written. They are sorted by page id across all instances and handed to the DiskScheduler in
+   * windows of up to BUFFER_POOL_FLUSH_WINDOW pages, so that runs of consecutive pages become single vectored writes
+   * that the workers of the scheduler execute in parallel. No instance latch is held while waiting for I/O, and only
+   * the pages of the current window are pinned, at most one in FLUSH_FRAME_SHARE frames of every instance.
+   *
+   * A page is written under its read latch, which is only tried, never waited for: a page that is still latched for
+   * writing after BUFFER_POOL_FLUSH_RETRIES retries, e.g. by the thread flushing, is left dirty for the next flush or
+   * page cleaner round, as is a page whose write failed. A page is only marked clean once it was written.
    */
   void FlushAllPages();
 
+  /**
+   * @brief Record the pages held by the buffer pool in the hot page list of the disk manager, the hottest first:
+   * pinned pages, then the others in the reverse order of their eviction. Called at clean shutdowns and checkpoints,
+   * so that WarmUp() can reload them after a restart.
+   * @return the number of pages recorded
+   */
+  auto SaveHotPages() -> size_t;
+
+  /**
+   * @brief Reload the pages of the hot page list into free frames, before the buffer pool is used after a restart.
+   * Pages are read in sorted runs of consecutive pages, and handed to the replacers so that the hottest pages are
+   * evicted last. Fetches of a page that is being reloaded wait for it, so the buffer pool can already be used.
+   * @param max_pages the maximum number of pages to reload, however long the list is
+   * @param budget the time after which the remaining pages are not read anymore
+   * @return the number of pages reloaded
+   */
+  auto WarmUp(size_t max_pages = SIZE_MAX,
+              std::chrono::milliseconds budget = std::chrono::milliseconds(BUFFER_POOL_WARMUP_MS)) -> size_t;
+
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
+   * @brief Delete a page from the buffer pool and deallocate it on disk, so that its page id can be reused. If the
    * page is pinned and cannot be deleted, return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
@@ -168,45 +368,233 @@ class BufferPoolManager {
    * imitate freeing the page on the disk.
    *
    * @param page_id id of page to be deleted
-   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   * @return false if the page exists but could not be deleted or the disk manager is read-only, true if the page
+   * didn't exist or deletion succeeded
    */
   auto DeletePage(page_id_t page_id) -> bool;
 
  private:
+  /** At most one in PREFETCH_FRAME_SHARE frames of an instance is being read ahead at any time. */
+  static constexpr size_t PREFETCH_FRAME_SHARE = 8;
+  /** At most one in FLUSH_FRAME_SHARE frames of an instance is pinned by a window of FlushAllPages() at any time. */
+  static constexpr size_t FLUSH_FRAME_SHARE = 4;
+
+  /** What is happening to the content of a frame. */
+  enum class FrameState {
+    /** The frame holds the latest content of its page (if any). */
+    Ready,
+    /** The previous page of the frame is being written back to disk. */
+    WritingBack,
+    /** The frame is being filled with its page. */
+    Loading,
+  };
+
+  /**
+   * One partition of the buffer pool. An instance owns a contiguous slice of `pages_` and all pages of the extents
+   * whose number is congruent to its index modulo the number of instances. Frame ids used inside an instance (page
+   * table, free list, replacer) are local to that slice.
+   */
+  struct BufferPoolInstance {
+    BufferPoolInstance(size_t index, Page *frames, size_t size, std::unique_ptr<Replacer> replacer);
+
+    /** Index of this instance, also the residue of the number of every extent it owns. */
+    const size_t index_;
+    /** Number of frames owned by this instance. */
+    const size_t size_;
+    /** The first frame owned by this instance. */
+    Page *frames_;
+    /** The first page of the next extent reserved by this instance, past the end of the database file. */
+    page_id_t next_extent_page_id_;
+    /** The extent of the pages that are not created for a table or index. */
+    PageExtent extent_;
+    /** Deallocated pages owned by this instance, reused before the file is extended. */
+    std::set<page_id_t> free_pages_;
+    /** Page table for keeping track of the pages held by this instance. */
+    std::unordered_map<page_id_t, frame_id_t> page_table_;
+    /** Replacer to find unpinned frames of this instance for replacement. */
+    std::unique_ptr<Replacer> replacer_;
+    /** List of free frames that don't have any pages on them. */
+    std::list<frame_id_t> free_list_;
+    /** Pages that were evicted but are still being written back, and the frame holding their content. */
+    std::unordered_map<page_id_t, frame_id_t> write_back_table_;
+    /** The state of every frame. */
+    std::vector<FrameState> frame_states_;
+    /** Signalled whenever I/O on a frame completes. */
+    std::vector<std::condition_variable> io_done_;
+    /** Frames holding a page that was read ahead and has not been fetched since. */
+    std::vector<bool> prefetched_;
+    /** Number of frames currently being read ahead. */
+    size_t prefetching_{0};
+    /** Signalled when the last read ahead of this instance completes. */
+    std::condition_variable prefetch_done_;
+    /** Recent access frequencies of the pages of this instance, for the admission filter. */
+    FrequencySketch sketch_;
+    /** Frames holding pages rejected by the admission filter, the one rejected first first. */
+    std::list<frame_id_t> probation_;
+    /** Position of every frame in probation_, or probation_.end() if it is not in there. */
+    std::vector<std::list<frame_id_t>::iterator> probation_pos_;
+    /** Protects the page table, the free list, the page id allocation and the metadata of the frames above. */
+    std::mutex latch_;
+  };
+
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** The page aligned memory holding the data of all frames when the disk manager does direct I/O, or nullptr. */
+  char *frame_arena_{nullptr};
+  /** Size of frame_arena_ in bytes. */
+  size_t frame_arena_size_{0};
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Schedules the reads and writes of the buffer pool on background workers. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /** The independent partitions of the buffer pool. */
+  std::vector<std::unique_ptr<BufferPoolInstance>> instances_;
+  /** The instance NewPage tries first, rotated so that new pages are spread evenly over the instances. */
+  std::atomic<size_t> next_instance_{0};
+  /** The lookback constant of LRU-K replacers. */
+  const size_t replacer_k_;
+  /** The replacement policy of every instance. */
+  std::atomic<ReplacerPolicy> replacer_policy_;
+  /** Number of pages read ahead of a scan. */
+  std::atomic<size_t> prefetch_depth_{BUFFER_POOL_PREFETCH_DEPTH};
+  /** Set at destruction, so that no read-ahead is started or continued anymore. */
+  std::atomic<bool> prefetch_stopped_{false};
+  /** Whether fetched pages go through the admission filter. */
+  std::atomic<bool> admission_filter_{false};
+  /** Second tier holding compressed copies of evicted pages, or nullptr. */
+  std::unique_ptr<CompressedPageCache> compressed_cache_;
+  /** Counters of the buffer pool. */
+  BufferPoolStats stats_;
+  /** The background page cleaner, if started. */
+  std::thread cleaner_thread_;
+  /** Tunables of the running page cleaner. */
+  PageCleanerOptions cleaner_options_;
+  /** Protects the stop flag of the page cleaner. */
+  std::mutex cleaner_latch_;
+  /** Wakes the page cleaner up to stop or to start a round early. */
+  std::condition_variable cleaner_cv_;
+  bool cleaner_stop_{false};
+  /** Set when a dirty page had to be evicted on the foreground path, so that the cleaner does not wait. */
+  std::atomic<bool> cleaner_kicked_{false};
+
+  /** @return the instance owning the given page */
+  auto InstanceOf(page_id_t page_id) -> BufferPoolInstance & {
+    return *instances_[page_id / BUFFER_POOL_EXTENT_SIZE % instances_.size()];
+  }
+
+  /**
+   * @brief Find a frame to hold a new page, from the free list first and then from the replacer. If the victim frame
+   * holds a dirty page, it is registered in the write back table and must be written back by FillFrame(). Caller
+   * should acquire the latch of the instance before calling this.
+   * @param instance the instance to take the frame from
+   * @param[out] frame_id the frame that can be reused
+   * @param[out] victim_page_id the dirty page to write back, or INVALID_PAGE_ID
+   * @param page_id the fetched page that goes into the frame, subject to the admission filter, or INVALID_PAGE_ID
+   * @return false if all frames of the instance are pinned
+   */
+  auto AcquireFrame(BufferPoolInstance &instance, frame_id_t *frame_id, page_id_t *victim_page_id,
+                    page_id_t page_id = INVALID_PAGE_ID) -> bool;
+
+  /**
+   * @brief Pick the frame for a fetched page, a free one first. With the admission filter, the frames the probationary
+   * area lacks are kept free, and a page that is colder than the victim of the replacer takes the oldest unpinned
+   * frame of the area instead, or one of those reserved frames; the victim is only evicted if there is neither.
+   * @param[out] probationary whether the page only gets a probationary frame
+   * @param[out] evict whether the frame holds a page to evict, false if it was free
+   * @return false if all frames of the instance are pinned
+   */
+  auto ChooseVictim(BufferPoolInstance &instance, page_id_t page_id, frame_id_t *frame_id, bool *probationary,
+                    bool *evict) -> bool;
+
+  /** @brief Take a frame out of the probationary area, if it is in there. Caller should hold the latch. */
+  void LeaveProbation(BufferPoolInstance &instance, frame_id_t frame_id);
+
+  /**
+   * @brief Give a frame back to the dirty page it was taken from, after the write back of that page failed, and unpin
+   * it. The page the frame was taken for is not resident anymore; threads that pinned the frame for it notice that the
+   * page id of the frame changed. Caller should hold the latch.
+   */
+  void RestoreVictim(BufferPoolInstance &instance, frame_id_t frame_id, page_id_t page_id, page_id_t victim_page_id);
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Write back the victim page of a pinned frame and fill it with its new page, without holding the latch.
+   * @param instance the instance owning the frame
+   * @param lock the held latch of the instance, released during I/O and held again on return
+   * @param frame_id the frame to fill, already registered in the page table and pinned
+   * @param victim_page_id the dirty page to write back first, or INVALID_PAGE_ID
+   * @param read_from_disk true to read the page from disk, false to zero it out
+   * @return false if the victim could not be written back; it is given its frame back, and the frame is unpinned
+   */
+  auto FillFrame(BufferPoolInstance &instance, std::unique_lock<std::mutex> &lock, frame_id_t frame_id,
+                 page_id_t victim_page_id, bool read_from_disk) -> bool;
+
+  /** @brief Write back a window of FlushAllPages(), given as page ids in ascending order with their instances. */
+  void FlushWindow(const std::vector<std::pair<page_id_t, BufferPoolInstance *>> &pages);
+
+  /**
+   * @brief Load a page from the compressed cache instead of the disk, if it is there. Caller should not hold the latch.
+   * @return false if the page has to be read from disk
+   */
+  auto LoadFromCompressedCache(page_id_t page_id, char *page_data) -> bool;
+
+  /** @brief Run page cleaner rounds until stopped. */
+  void PageCleanerLoop();
+
+  /**
+   * @brief Write back the dirty pages among the next eviction candidates of an instance, until the free and clean
+   * frames at the eviction end reach the target.
+   * @return the number of pages written back
+   */
+  auto CleanInstance(BufferPoolInstance &instance) -> size_t;
+
+  /** @brief Acquire the latch of an instance, and account for the time spent waiting for it. */
+  auto LockInstance(BufferPoolInstance &instance) -> std::unique_lock<std::mutex>;
+
+  /** @brief FetchPage() without the latency accounting. */
+  auto FetchFrame(page_id_t page_id, AccessType access_type) -> Page *;
+
+  /** @brief Pin the distinct pages of a batch in page id order, up to the first one that cannot be fetched. */
+  auto FetchFrames(const std::vector<page_id_t> &page_ids, AccessType access_type) -> std::vector<Page *>;
+
+  /** @brief Wait until the given page is no longer being written back. Caller should hold the latch. */
+  void WaitForWriteBack(BufferPoolInstance &instance, std::unique_lock<std::mutex> &lock, page_id_t page_id);
+
+  /**
+   * @brief Read ahead up to `remaining` pages of a chain, starting at page_id. Returns once the first page that is not
+   * resident has been scheduled for reading; the rest of the chain is continued when that read completes.
+   */
+  void PrefetchChain(page_id_t page_id, size_t remaining, NextPageFn next_page);
+
+  /**
+   * @brief Schedule the asynchronous read of a page into a frame reserved for read-ahead, after writing back the dirty
+   * victim of the frame if there is one. Once loaded, the frame is unpinned and the chain is continued.
+   */
+  void PrefetchFrame(BufferPoolInstance &instance, frame_id_t frame_id, page_id_t victim_page_id, size_t remaining,
+                     NextPageFn next_page);
+
+  /**
+   * @brief Allocate a page on disk. The next page of a table or index extent comes first, then the lowest deallocated
+   * page of the instance, and a new extent is reserved when neither is left. Caller should acquire the latch of the
+   * instance before calling this function.
+   * @param instance the instance that will own the page
+   * @param extent the extent to allocate from, either the one of the instance or one owned by the instance
+   * @param[out] new_extent_page_id the first page of the newly reserved extent, whose disk space the caller should
+   * reserve, or INVALID_PAGE_ID
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(BufferPoolInstance &instance, PageExtent *extent, page_id_t *new_extent_page_id) -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk, and record it in the free page map. A page that was never handed out or is free
+   * already is left alone. Caller should acquire the latch of the instance owning the page before calling this
+   * function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
-
-  // TODO(student): You may add additional private members and helper functions
+  void DeallocatePage(page_id_t page_id);
 };
 }  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/latency_histogram.h"
+
+namespace bustub {
+
+/**
+ * Counters of a buffer pool. They are updated without holding any latch, so a snapshot taken while the buffer pool is
+ * in use may be slightly inconsistent.
+ */
+struct BufferPoolStats {
+  /** Number of access types, the counters below are indexed by AccessType. */
+  static constexpr size_t NUM_ACCESS_TYPES = 3;
+
+  /** Fetches that found their page in the buffer pool. */
+  std::array<std::atomic<uint64_t>, NUM_ACCESS_TYPES> fetch_hits_{};
+  /** Fetches that had to read their page from disk. */
+  std::array<std::atomic<uint64_t>, NUM_ACCESS_TYPES> fetch_misses_{};
+  /** Pages read into the buffer pool ahead of a scan. */
+  std::atomic<uint64_t> prefetch_issued_{0};
+  /** Prefetched pages that were fetched before being evicted. */
+  std::atomic<uint64_t> prefetch_hits_{0};
+  /** Prefetched pages that were evicted or deleted without ever being fetched. */
+  std::atomic<uint64_t> prefetch_wasted_{0};
+  /** Frames taken from the replacer to hold another page. */
+  std::atomic<uint64_t> evictions_{0};
+  /** Frames reused while still holding a dirty page, which had to be written back on the foreground path. */
+  std::atomic<uint64_t> dirty_evictions_{0};
+  /** Pages written back by the page cleaner ahead of their eviction. */
+  std::atomic<uint64_t> cleaner_writes_{0};
+  /** FetchPage() and NewPage() calls that returned nullptr because every frame was pinned. */
+  std::atomic<uint64_t> pin_failures_{0};
+  /** Acquisitions of an instance latch that had to wait for another thread. */
+  std::atomic<uint64_t> latch_waits_{0};
+  /** Time spent waiting for instance latches, in nanoseconds. */
+  std::atomic<uint64_t> latch_wait_ns_{0};
+  /** Fetched pages that the admission filter only gave a probationary frame. */
+  std::atomic<uint64_t> admission_rejects_{0};
+  /** Pages that left the probationary area because they were fetched again. */
+  std::atomic<uint64_t> admission_promotions_{0};
+  /** Misses of the buffer pool that found their page in the compressed cache. */
+  std::atomic<uint64_t> compressed_hits_{0};
+  /** Misses of the buffer pool that were not in the compressed cache either, while it is enabled. */
+  std::atomic<uint64_t> compressed_misses_{0};
+  /** Evicted pages stored in the compressed cache. */
+  std::atomic<uint64_t> compressed_stores_{0};
+  /** Size of the pages stored in the compressed cache, after compression. */
+  std::atomic<uint64_t> compressed_bytes_{0};
+  /** Latency of FetchPage(), hits and misses alike. */
+  LatencyHistogram fetch_latency_;
+  /** Latency of page reads, from their submission to the disk scheduler to their completion. */
+  LatencyHistogram disk_read_latency_;
+
+  /** @return the share of fetches of the given type that found their page in the buffer pool */
+  auto HitRate(AccessType access_type) const -> double {
+    auto i = static_cast<size_t>(access_type);
+    uint64_t hits = fetch_hits_[i];
+    uint64_t total = hits + fetch_misses_[i];
+    return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+  }
+
+  /** @return the share of the buffer pool misses that the compressed cache served */
+  auto CompressedHitRate() const -> double {
+    uint64_t hits = compressed_hits_;
+    uint64_t total = hits + compressed_misses_;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+  }
+
+  /** @return every counter as a (name, value) row, for shells and benchmarks */
+  auto Describe() const -> std::vector<std::pair<std::string, std::string>>;
+};
+
+}  // namespace bustub
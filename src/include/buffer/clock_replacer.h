@@ -12,17 +12,24 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame has a reference bit that is set on access. The clock hand sweeps over the frames, clearing reference
+ * bits, and evicts the first evictable frame whose bit is already clear. Accesses to a tracked frame only set its
+ * reference bit, without taking the latch, so that cache hits never contend with each other or with the clock hand.
+ * Scan accesses leave the reference bit alone.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -32,21 +39,39 @@ class ClockReplacer : public Replacer {
    */
   explicit ClockReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
   /**
    * Destroys the ClockReplacer.
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  const size_t num_frames_;
+  /** Whether the replacer tracks a frame, only changed while holding the latch. */
+  std::unique_ptr<std::atomic<bool>[]> tracked_;
+  /** The reference bit of every frame. */
+  std::unique_ptr<std::atomic<bool>[]> referenced_;
+  /** Whether a tracked frame may be evicted. */
+  std::vector<bool> evictable_;
+  /** The next frame the clock hand looks at. */
+  size_t hand_{0};
+  std::atomic<size_t> curr_size_{0};
+  /** Protects the clock hand, tracking and evictability. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a second tier behind the frames of a buffer pool. It keeps compressed copies of evicted pages
+ * in a bounded amount of memory, so that a page coming back soon after its eviction is decompressed instead of read
+ * from disk. The cache is exclusive: a page is taken out of it when it is loaded into a frame, and put back when it is
+ * evicted again. Once the capacity is reached, the pages that were put the longest time ago go first.
+ *
+ * Pages are compressed with a byte oriented LZ77 scheme that finds its matches through a small hash table. It is fast
+ * rather than tight, which suits pages: their free space and repeated values are what makes them compressible.
+ *
+ * The cache has its own latch, and it never holds it while compressing or decompressing.
+ */
+class CompressedPageCache {
+ public:
+  /** Memory accounted to every cached page on top of its compressed data, for the bookkeeping of the cache. */
+  static constexpr size_t ENTRY_OVERHEAD = 64;
+
+  /**
+   * Create a new CompressedPageCache.
+   * @param capacity the memory the cached pages may take, in bytes
+   */
+  explicit CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Keep a copy of a page that leaves the buffer pool. An older copy of the page is replaced.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return the size of the stored copy in bytes, 0 if it does not fit into the cache
+   */
+  auto Put(page_id_t page_id, const char *page_data) -> size_t;
+
+  /**
+   * Take a page out of the cache.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @return false if the page is not cached
+   */
+  auto Take(page_id_t page_id, char *page_data) -> bool;
+
+  /** Forget a page, e.g. because it was deallocated. */
+  void Erase(page_id_t page_id);
+
+  /** @return the number of cached pages */
+  auto Size() -> size_t;
+
+  /** @return the memory taken by the cached pages, in bytes */
+  auto UsedBytes() -> size_t;
+
+  /**
+   * Compress a page.
+   * @param page_data raw page data
+   * @param[out] out output buffer
+   * @param out_capacity size of the output buffer
+   * @return the size of the compressed page, 0 if it does not fit into the output buffer
+   */
+  static auto Compress(const char *page_data, char *out, size_t out_capacity) -> size_t;
+
+  /**
+   * Decompress a page.
+   * @param in compressed page
+   * @param in_size size of the compressed page
+   * @param[out] page_data output buffer of BUSTUB_PAGE_SIZE bytes
+   * @return false if the input is not a valid compressed page
+   */
+  static auto Decompress(const char *in, size_t in_size, char *page_data) -> bool;
+
+ private:
+  struct Entry {
+    page_id_t page_id_;
+    /** Compressed data, or the raw page if it does not compress. */
+    std::string data_;
+    bool compressed_;
+  };
+
+  /** Drop an entry. Caller should hold the latch. */
+  void EraseEntry(std::list<Entry>::iterator it);
+
+  const size_t capacity_;
+  size_t used_bytes_{0};
+  /** Cached pages, the one put the longest time ago first. */
+  std::list<Entry> entries_;
+  /** Position of every cached page in entries_. */
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frequency_sketch.h
+//
+// Identification: src/include/buffer/frequency_sketch.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrequencySketch estimates how often pages were accessed recently, in a fixed amount of memory, as a count-min
+ * sketch: every page has a small saturating counter in each of DEPTH rows, and its estimate is the smallest of them.
+ * Once the sketch has counted ten times as many accesses as the buffer pool has frames, all counters are halved, so
+ * that pages which were hot a long time ago fade out. Admission filters in the style of TinyLFU use it to tell whether
+ * a page is worth the frame of another one.
+ */
+class FrequencySketch {
+ public:
+  /** Number of rows, i.e. of counters per page. */
+  static constexpr size_t DEPTH = 4;
+  /** Counters saturate at this value. */
+  static constexpr uint8_t MAX_COUNT = 15;
+
+  /**
+   * Create a new FrequencySketch.
+   * @param num_frames the number of frames of the buffer pool the sketch serves
+   */
+  explicit FrequencySketch(size_t num_frames) : sample_size_(10 * std::max<size_t>(num_frames, 1)) {
+    while (width_ < 2 * num_frames) {
+      width_ <<= 1;
+    }
+    counters_.assign(DEPTH * width_, 0);
+  }
+
+  /** Count an access to a page. */
+  void Increment(page_id_t page_id) {
+    bool counted = false;
+    for (size_t row = 0; row < DEPTH; ++row) {
+      auto &counter = counters_[row * width_ + Slot(page_id, row)];
+      if (counter < MAX_COUNT) {
+        counter++;
+        counted = true;
+      }
+    }
+    if (counted && ++additions_ >= sample_size_) {
+      Age();
+    }
+  }
+
+  /** @return the estimated number of recent accesses to a page, never less than the actual number up to MAX_COUNT */
+  auto Estimate(page_id_t page_id) const -> uint8_t {
+    uint8_t estimate = MAX_COUNT;
+    for (size_t row = 0; row < DEPTH; ++row) {
+      estimate = std::min(estimate, counters_[row * width_ + Slot(page_id, row)]);
+    }
+    return estimate;
+  }
+
+ private:
+  /** Halve every counter. */
+  void Age() {
+    for (auto &counter : counters_) {
+      counter >>= 1;
+    }
+    additions_ /= 2;
+  }
+
+  /** @return the counter of a page in a row, from an independent hash per row */
+  auto Slot(page_id_t page_id, size_t row) const -> size_t {
+    uint64_t x = static_cast<uint64_t>(page_id) + (row + 1) * 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x & (width_ - 1);
+  }
+
+  /** Number of counters per row, a power of two of at least twice the number of frames. */
+  size_t width_{64};
+  /** DEPTH rows of width_ counters. */
+  std::vector<uint8_t> counters_;
+  /** Accesses counted since the counters were last halved. */
+  size_t additions_{0};
+  /** Number of accesses after which the counters are halved. */
+  const size_t sample_size_;
+};
+
+}  // namespace bustub
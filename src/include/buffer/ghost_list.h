@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ghost_list.h
+//
+// Identification: src/include/buffer/ghost_list.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * GhostList remembers the ids of recently evicted pages, without their content, in the order they were evicted.
+ * Replacement policies such as 2Q and ARC use it to recognize a page that comes back soon after its eviction.
+ */
+class GhostList {
+ public:
+  /** @return true if the page is remembered */
+  auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) > 0; }
+
+  /** @return the number of remembered pages */
+  auto Size() const -> size_t { return pages_.size(); }
+
+  /** Remember a page as the most recently evicted one. */
+  void Push(page_id_t page_id) {
+    Erase(page_id);
+    pages_.push_back(page_id);
+    index_.emplace(page_id, std::prev(pages_.end()));
+  }
+
+  /** Forget the page that was evicted the longest time ago. */
+  void PopOldest() {
+    if (!pages_.empty()) {
+      index_.erase(pages_.front());
+      pages_.pop_front();
+    }
+  }
+
+  /**
+   * Forget a page.
+   * @return true if the page was remembered
+   */
+  auto Erase(page_id_t page_id) -> bool {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+ private:
+  /** Evicted pages, the oldest first. */
+  std::list<page_id_t> pages_;
+  /** Position of every remembered page in pages_. */
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -13,30 +13,37 @@
 #pragma once
 
 #include <algorithm>
+#include <deque>
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
+#include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
 class LRUKNode {
  public:
   /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
-  LRUKNode() = default;
-
-  explicit LRUKNode(size_t access_cnt) : access_cnt_(access_cnt) {}
+  std::deque<size_t> history_;
+  /** Total number of accesses recorded, saturating at k. */
   size_t access_cnt_{0};
   bool is_evictable_{false};
+  /** True while the frame has only been accessed by scans. Such a frame only keeps its latest access. */
+  bool scan_only_{false};
 
- private:
+  /** @return true if the replacer currently tracks the frame */
+  auto IsTracked() const -> bool { return !history_.empty(); }
+
+  /**
+   * @return the ordering key of the frame. For a frame with less than k accesses this is its earliest access, for the
+   * others it is the k-th most recent access, i.e. a smaller key means a larger backward k-distance.
+   */
+  auto Key() const -> size_t { return history_.front(); }
 };
 
 /**
@@ -49,8 +56,17 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Only evictable frames are kept in the ordered eviction sets, one for frames with +inf backward
+ * k-distance and one for the others, so that lookup is O(1) and eviction, promotion and pinning
+ * are O(log n) and never have to walk over pinned frames.
+ *
+ * Scans are kept from flushing the working set: frames that have only been touched by
+ * AccessType::Scan accesses live in a separate ring, ordered by their latest access, which is
+ * evicted before everything else. Scan accesses to a frame outside of the ring are not recorded,
+ * and the first other access moves a frame out of the ring with a fresh history.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -68,7 +84,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -86,7 +102,9 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
   /**
    * TODO(P1): Add implementation
@@ -100,8 +118,10 @@ class LRUKReplacer {
    * @param frame_id id of frame that received a new access.
    * @param access_type type of access that was received. This parameter is only needed for
    * leaderboard tests.
+   * @param page_id the page held by the frame, not needed by LRU-K
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
   /**
    * TODO(P1): Add implementation
@@ -120,7 +140,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -141,7 +161,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -150,14 +170,29 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  std::unordered_map<frame_id_t, LRUKNode> node_store_;
-  std::list<frame_id_t> hist_list_;
-  std::list<frame_id_t> cache_list_;
+  /** An evictable frame in an eviction set, ordered by LRUKNode::Key(). */
+  using EvictionEntry = std::pair<size_t, frame_id_t>;
+
+  /** @return the eviction set the frame belongs to while it is evictable */
+  auto EvictionSetOf(const LRUKNode &node) -> std::set<EvictionEntry> & {
+    if (node.scan_only_) {
+      return scan_set_;
+    }
+    return node.access_cnt_ < k_ ? hist_set_ : cache_set_;
+  }
+
+  /** Access history of every frame, indexed by frame id. */
+  std::vector<LRUKNode> node_store_;
+  /** Evictable frames that have only been accessed by scans, evicted first. */
+  std::set<EvictionEntry> scan_set_;
+  /** Evictable frames with less than k accesses, i.e. +inf backward k-distance. */
+  std::set<EvictionEntry> hist_set_;
+  /** Evictable frames with at least k accesses. */
+  std::set<EvictionEntry> cache_set_;
+  size_t current_timestamp_{0};
   std::atomic<size_t> curr_size_ = 0;
   size_t replacer_size_;
   size_t k_;
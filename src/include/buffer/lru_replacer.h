@@ -12,19 +12,16 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <vector>
-
-#include "buffer/replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "common/config.h"
 
 namespace bustub {
 
 /**
- * LRUReplacer implements the Least Recently Used replacement policy.
+ * LRUReplacer implements the Least Recently Used replacement policy, which is LRU-K with K = 1: the frame whose latest
+ * access is the oldest is evicted first. Frames only touched by scans still go before everything else.
  */
-class LRUReplacer : public Replacer {
+class LRUReplacer : public LRUKReplacer {
  public:
   /**
    * Create a new LRUReplacer.
@@ -36,17 +33,6 @@ class LRUReplacer : public Replacer {
    * Destroys the LRUReplacer.
    */
   ~LRUReplacer() override;
-
-  auto Victim(frame_id_t *frame_id) -> bool override;
-
-  void Pin(frame_id_t frame_id) override;
-
-  void Unpin(frame_id_t frame_id) override;
-
-  auto Size() -> size_t override;
-
- private:
-  // TODO(student): implement me!
 };
 
 }  // namespace bustub
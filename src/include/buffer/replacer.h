@@ -12,12 +12,25 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+enum class AccessType { Unknown = 0, Get, Scan };
+
+/** The replacement policies a buffer pool can be created with. */
+enum class ReplacerPolicy { LRUK = 0, LRU, Clock, TwoQueue, ARC };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks the frame to reuse when the buffer pool is full.
+ *
+ * The buffer pool records every access to a frame, and marks a frame evictable while it is not pinned. Only evictable
+ * frames are handed out by Evict(). The buffer pool calls a replacer while holding the latch of its instance, but
+ * replacers are still safe to use from several threads on their own.
  */
 class Replacer {
  public:
@@ -25,26 +38,61 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * Find the frame to reuse according to the replacement policy and stop tracking it.
+   * @param[out] frame_id id of the evicted frame
+   * @return true if a frame was evicted, false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Return the frames Evict() would hand out next, in eviction order, without evicting them. Policies whose order
+   * depends on the evictions themselves return their best guess.
+   * @param max_count the maximum number of frames to return
+   * @return up to max_count evictable frames, the next victim first
+   */
+  virtual auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> = 0;
+
+  /**
+   * Record an access to a frame, and start tracking the frame if it is not tracked yet.
+   * @param frame_id the accessed frame
+   * @param access_type the type of the access, scans should not displace the working set
+   * @param page_id the page held by the frame, used by policies that remember recently evicted pages
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                            page_id_t page_id = INVALID_PAGE_ID) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Toggle whether a tracked frame may be evicted. Frames that are not tracked are ignored.
+   * @param frame_id the frame to update
+   * @param set_evictable whether the frame can be evicted
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Stop tracking an evictable frame, whatever its position in the eviction order. Used when a page is deleted.
+   * @param frame_id the frame to remove
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /** @return the number of frames that can be evicted */
   virtual auto Size() -> size_t = 0;
 };
 
+/**
+ * Create a replacer.
+ * @param policy the replacement policy
+ * @param num_frames the number of frames the replacer has to track
+ * @param k the lookback constant, only used by LRU-K
+ */
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
+
+/**
+ * Parse the name of a replacement policy: "lru-k", "lru", "clock", "2q" or "arc", in any case.
+ * @return false if the name is unknown
+ */
+auto ParseReplacerPolicy(const std::string &name, ReplacerPolicy *policy) -> bool;
+
+/** @return the name of a replacement policy, as accepted by ParseReplacerPolicy() */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
 }  // namespace bustub
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q replacement policy (Johnson & Shasha, VLDB '94).
+ *
+ * Frames enter the A1in FIFO on their first access. Further accesses while in A1in are treated as correlated and do
+ * not change anything. Once A1in holds more than a quarter of the frames, its oldest frame is evicted, and the page it
+ * held is remembered in the A1out ghost list. A page that is read again while in A1out is hot, and goes to the Am LRU
+ * list instead. Scan accesses never promote a page.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+ private:
+  enum class Queue { None, A1in, Am };
+
+  struct TwoQueueNode {
+    Queue queue_{Queue::None};
+    /** The admission into A1in, or the latest access in Am. */
+    size_t key_{0};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    bool is_evictable_{false};
+  };
+
+  /** An evictable frame in an eviction set, ordered by TwoQueueNode::key_. */
+  using EvictionEntry = std::pair<size_t, frame_id_t>;
+
+  auto EvictionSetOf(const TwoQueueNode &node) -> std::set<EvictionEntry> & {
+    return node.queue_ == Queue::A1in ? a1in_set_ : am_set_;
+  }
+
+  /** @return true if the next victim comes from A1in */
+  auto EvictFromA1in() const -> bool { return !a1in_set_.empty() && (a1in_size_ > kin_ || am_set_.empty()); }
+
+  std::vector<TwoQueueNode> node_store_;
+  /** Evictable frames of A1in, the oldest admission first. */
+  std::set<EvictionEntry> a1in_set_;
+  /** Evictable frames of Am, the least recently used first. */
+  std::set<EvictionEntry> am_set_;
+  /** Pages recently evicted from A1in. */
+  GhostList a1out_;
+  /** Number of frames in A1in, pinned or not. */
+  size_t a1in_size_{0};
+  /** Number of frames A1in may hold before it gives up frames ahead of Am. */
+  const size_t kin_;
+  /** Number of pages remembered in A1out. */
+  const size_t kout_;
+  size_t current_timestamp_{0};
+  std::atomic<size_t> curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -20,6 +20,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
@@ -228,11 +229,34 @@ class Catalog {
     // TODO(chi): support both hash index and btree index
     auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, sorted and built bottom up rather than inserted one by one
     auto *table_meta = GetTable(table_name);
-    for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
-      auto [meta, tuple] = iter.GetTuple();
-      index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
+    auto iter = table_meta->table_->MakeIterator();
+    bool loaded;
+    try {
+      loaded = index->BulkLoad([&](Tuple *key, RID *rid) {
+        if (iter.IsEnd()) {
+          return false;
+        }
+        auto [meta, tuple] = iter.GetTuple();
+        *key = tuple.KeyFromTuple(schema, key_schema, key_attrs);
+        *rid = tuple.GetRid();
+        ++iter;
+        return true;
+      });
+    } catch (const Exception &e) {
+      // the sort or the tree ran out of frames, and gave back the pages it had taken: the index is still empty
+      if (e.GetType() != ExceptionType::OUT_OF_MEMORY) {
+        throw;
+      }
+      loaded = false;
+    }
+    if (!loaded) {
+      // inserting the tuples one by one only takes the frames of one path of the tree at a time
+      for (auto insert_iter = table_meta->table_->MakeIterator(); !insert_iter.IsEnd(); ++insert_iter) {
+        auto [meta, tuple] = insert_iter.GetTuple();
+        index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
+      }
     }
 
     // Get the next OID for the new index
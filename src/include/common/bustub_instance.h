@@ -218,7 +218,12 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn, bool is_modify) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Open a database file.
+   * @param db_file_name the database file
+   * @param direct_io true to access the database file with direct I/O, bypassing the page cache of the operating system
+   */
+  explicit BustubInstance(const std::string &db_file_name, bool direct_io = false);
 
   BustubInstance();
 
@@ -278,6 +283,7 @@ class BustubInstance {
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
+  void CmdDisplayBpmStats(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
 
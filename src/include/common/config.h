@@ -36,6 +36,22 @@ static constexpr int BUFFER_POOL_SIZE = 10;
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int DISK_SCHEDULER_NUM_WORKERS = 4;  // number of background workers of the disk scheduler
+static constexpr int BUFFER_POOL_PREFETCH_DEPTH = 8;  // number of pages read ahead of a scan
+static constexpr int BUFFER_POOL_EXTENT_SIZE = 64;    // number of contiguous pages reserved at once per table/index
+static constexpr bool BUFFER_POOL_HUGE_PAGES = true;  // back the frames of a direct I/O buffer pool by huge pages
+static constexpr int PAGE_CLEANER_CLEAN_TARGET_PERCENT = 25;  // share of frames the page cleaner keeps free or clean
+static constexpr int PAGE_CLEANER_MAX_WRITES = 32;            // pages written per instance in one page cleaner round
+static constexpr int PAGE_CLEANER_INTERVAL_MS = 10;           // time between two page cleaner rounds
+static constexpr int BUFFER_POOL_FLUSH_WINDOW = 1024;         // max dirty pages pinned at once by FlushAllPages
+static constexpr int BUFFER_POOL_FLUSH_RETRIES = 3;           // retries of FlushAllPages for pages latched by a writer
+static constexpr int BUFFER_POOL_PROBATION_PERCENT = 5;       // share of frames for pages the admission filter rejects
+static constexpr int BUFFER_POOL_WARMUP_MS = 3000;            // time budget of reloading the hot pages after a restart
+static constexpr int INDEX_SCAN_BATCH_SIZE = 32;              // RIDs whose heap pages an index scan fetches together
+static constexpr int MMAP_READAHEAD_PAGES = 64;               // pages a scan on a mapped db file advises ahead of it
+static constexpr int EXTERNAL_SORT_MEMORY = 64 << 20;         // bytes an external sort buffers before spilling a run
+static constexpr int EXTERNAL_SORT_MERGE_FANIN = 8;           // sorted runs an external sort merges at once
+static constexpr int INDEX_BULK_LOAD_FILL_PERCENT = 90;       // how full bulk loading fills the pages of a B+ tree
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.h
+//
+// Identification: src/include/common/latency_histogram.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+/**
+ * LatencyHistogram counts latencies in buckets whose bounds are powers of two nanoseconds. Recording is lock free and
+ * costs two relaxed atomic increments, so it can be used on hot paths. Percentiles are only known up to the bucket,
+ * i.e. within a factor of two.
+ */
+class LatencyHistogram {
+ public:
+  /** Number of buckets. Bucket 0 holds latencies of 0ns, bucket i holds [2^(i-1), 2^i) ns, the last one the rest. */
+  static constexpr size_t NUM_BUCKETS = 48;
+
+  /** Record one latency. */
+  void Record(std::chrono::nanoseconds latency) {
+    auto ns = static_cast<uint64_t>(latency.count() > 0 ? latency.count() : 0);
+    size_t bucket = ns == 0 ? 0 : 64 - __builtin_clzll(ns);
+    buckets_[bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1].fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+  }
+
+  /** @return the number of recorded latencies */
+  auto Count() const -> uint64_t {
+    uint64_t count = 0;
+    for (const auto &bucket : buckets_) {
+      count += bucket.load(std::memory_order_relaxed);
+    }
+    return count;
+  }
+
+  /** @return the mean of the recorded latencies in nanoseconds, or 0 if there are none */
+  auto MeanNs() const -> double {
+    uint64_t count = Count();
+    return count == 0 ? 0.0 : static_cast<double>(sum_ns_.load(std::memory_order_relaxed)) / count;
+  }
+
+  /**
+   * @param percentile the share of latencies, between 0 and 1
+   * @return an upper bound in nanoseconds of the given share of the recorded latencies, or 0 if there are none
+   */
+  auto PercentileNs(double percentile) const -> uint64_t {
+    uint64_t count = Count();
+    if (count == 0) {
+      return 0;
+    }
+    auto target = static_cast<uint64_t>(percentile * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      seen += buckets_[i].load(std::memory_order_relaxed);
+      if (seen > 0 && seen >= target) {
+        return i == 0 ? 0 : uint64_t{1} << i;
+      }
+    }
+    return uint64_t{1} << (NUM_BUCKETS - 1);
+  }
+
+  /** @return a one line summary, with latencies in microseconds */
+  auto ToString() const -> std::string {
+    return fmt::format("count={} mean={:.2f}us p50<={:.2f}us p99<={:.2f}us p999<={:.2f}us", Count(), MeanNs() / 1000,
+                       PercentileNs(0.5) / 1000.0, PercentileNs(0.99) / 1000.0, PercentileNs(0.999) / 1000.0);
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+  std::atomic<uint64_t> sum_ns_{0};
+};
+
+}  // namespace bustub
@@ -12,12 +12,16 @@
 
 #pragma once
 
+#include <optional>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/page/page_guard.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -42,10 +46,32 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** @return the key a bound of the plan stands for in the index */
+  auto MakeBound(const std::optional<IndexScanBound> &bound) const -> std::optional<IndexKeyBound<IntegerKeyType>>;
+
+  /** @return an iterator over the entries of the tree the plan asks for */
+  template <class Tree>
+  auto MakeIterator(Tree *tree) const -> decltype(tree->GetBeginIterator());
+
+  /**
+   * Take the next RIDs from the index and pin their heap pages with one batch, releasing the pages of the last one.
+   * @return false if the index has no more entries
+   */
+  auto FetchBatch() -> bool;
+
+  /** @return the tuple of a RID of the batch, read from its pinned heap page */
+  auto GetTuple(const RID &rid) -> std::pair<TupleMeta, Tuple>;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   const TableInfo *table_info_;
   IndexInfo *index_info_;
-  BPlusTreeIndexIteratorForTwoIntegerColumn iter_{nullptr, -1, -1};
+  /** The iterator of the tree, whose type depends on the comparator that was chosen when the index was created. */
+  std::variant<BPlusTreeIndexIteratorForTwoIntegerColumn, BPlusTreeIndexIteratorForTwoColumn> iter_;
+  /** RIDs taken from the index whose tuples are not emitted yet, from batch_pos_ on. */
+  std::vector<RID> batch_;
+  size_t batch_pos_{0};
+  /** Pins of the heap pages of the batch in page id order, possibly not all of them if the buffer pool ran short. */
+  std::vector<BasicPageGuard> guards_;
 };
 }  // namespace bustub
@@ -12,14 +12,23 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "type/value.h"
 
 namespace bustub {
+
+/** A bound of the keys an index scan reads, which the scan includes if inclusive_. */
+struct IndexScanBound {
+  Value value_;
+  bool inclusive_;
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
  */
@@ -33,6 +42,22 @@ class IndexScanPlanNode : public AbstractPlanNode {
   IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
       : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
 
+  /**
+   * Creates a new index scan plan node that reads a range of the keys of a single column index.
+   * @param output The output format of this scan plan node
+   * @param index_oid The identifier of the index to be scanned
+   * @param lower The lower bound of the keys, if any
+   * @param upper The upper bound of the keys, if any
+   * @param reverse Whether to read the keys in descending order
+   */
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, std::optional<IndexScanBound> lower,
+                    std::optional<IndexScanBound> upper, bool reverse)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        lower_(std::move(lower)),
+        upper_(std::move(upper)),
+        reverse_(reverse) {}
+
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
@@ -43,11 +68,23 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The keys to read, all of them if there is no bound. */
+  std::optional<IndexScanBound> lower_;
+  std::optional<IndexScanBound> upper_;
+  /** Whether the keys are read in descending order. */
+  bool reverse_{false};
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    if (!lower_.has_value() && !upper_.has_value() && !reverse_) {
+      return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    }
+    std::string range = lower_.has_value()
+                            ? fmt::format("{}{}", lower_->inclusive_ ? "[" : "(", lower_->value_.ToString())
+                            : "(-inf";
+    range += upper_.has_value() ? fmt::format(", {}{}", upper_->value_.ToString(), upper_->inclusive_ ? "]" : ")")
+                                : ", +inf)";
+    return fmt::format("IndexScan {{ index_oid={}, range={}, reverse={} }}", index_oid_, range, reverse_);
   }
 };
 
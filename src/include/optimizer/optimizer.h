@@ -80,7 +80,14 @@ class Optimizer {
   auto IsPredicateTrue(const AbstractExpressionRef &expr) -> bool;
 
   /**
-   * @brief optimize order by as index scan if there's an index on a table
+   * @brief optimize a filter over a seq scan as a range scan of an index, if the filter compares a column with an
+   * index of its own with constants, e.g. `WHERE k BETWEEN 1 AND 10`. The filter is kept on top of the index scan.
+   * The children of INSERT, DELETE and UPDATE are left alone, since they modify the index while it is being scanned.
+   */
+  auto OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief optimize order by as index scan if there's an index on a table, scanning it backwards for descending order
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
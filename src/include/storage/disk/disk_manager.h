@@ -13,10 +13,10 @@
 #pragma once
 
 #include <atomic>
-#include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 
@@ -25,19 +25,33 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional I/O on a file descriptor, so requests on different pages can be served
+ * concurrently. Page writes only reach the operating system; they become durable with Sync(), which is called at
+ * checkpoints. Log writes are made durable before WriteLog() returns, since the log is forced at commit.
+ *
+ * The disk manager also keeps the free page map: one bit per page, set while the page is deallocated. The map is
+ * stored next to the database file, so that the buffer pool can reuse the pages freed before a restart. So is the list
+ * of hot pages, which the buffer pool dumps at shutdown and checkpoints and reloads after a restart.
+ *
+ * In direct I/O mode, the database file is opened with O_DIRECT, so that pages are not cached a second time by the
+ * operating system. Page buffers that are not aligned to BUSTUB_PAGE_SIZE then go through an aligned bounce buffer; the
+ * buffer pool hands out aligned frames in this mode so that its I/O never needs one.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the page cache of the operating system, which is silently not done if the file
+   * system does not support it
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -45,12 +59,24 @@ class DiskManager {
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Make all the page writes so far durable.
+   */
+  virtual void Sync();
+
+  /**
+   * Write a page to the database file. Throws an Exception if the page cannot be written.
    * @param page_id id of the page
    * @param page_data raw page data
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Write a run of consecutive pages to the database file. Throws an Exception if any of them cannot be written.
+   * @param first_page_id id of the first page
+   * @param pages raw data of the pages `first_page_id`, `first_page_id + 1`, ...
+   */
+  virtual void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages);
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -58,6 +84,68 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read a run of consecutive pages from the database file with vectored I/O.
+   * @param first_page_id id of the first page
+   * @param[out] pages output buffers of the pages `first_page_id`, `first_page_id + 1`, ...
+   */
+  virtual void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages);
+
+  /**
+   * Record in the free page map whether a page is deallocated. Changes are only made in memory, so that allocating a
+   * page costs no I/O; they are written to the map file and made durable by Sync(), together with the page writes
+   * they go with, and written at ShutDown().
+   * @param page_id id of the page
+   * @param is_free true if the page was deallocated, false if it is in use again
+   */
+  virtual void SetPageFree(page_id_t page_id, bool is_free);
+
+  /**
+   * Record in the free page map that a run of pages is not in use, e.g. the pages of an extent that was just reserved,
+   * as SetPageFree() does for every one of them.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages
+   */
+  virtual void SetPagesFree(page_id_t first_page_id, page_id_t num_pages);
+
+  /** @return the deallocated pages recorded in the free page map, in increasing order */
+  auto GetFreePages() -> std::vector<page_id_t>;
+
+  /**
+   * Replace the list of hot pages stored next to the database file, which the buffer pool reloads after a restart.
+   * The list is replaced atomically, a crash leaves either the old or the new list behind.
+   * @param page_ids the hot pages, the hottest first
+   */
+  virtual void WriteHotPages(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * @param max_count the maximum number of pages to read, however long the stored list is
+   * @return the hottest pages of the stored hot page list, the hottest first, or nothing if there is no list
+   */
+  virtual auto ReadHotPages(size_t max_count) -> std::vector<page_id_t>;
+
+  /** @return the number of pages the database file spans, pages past the end of the file were never written */
+  virtual auto GetNumPages() -> page_id_t;
+
+  /**
+   * Reserve the disk space of a run of pages that will be written soon, without changing the size of the file, so that
+   * the pages end up physically contiguous and writing them does not have to extend the file one page at a time.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages to reserve
+   * @return false if space cannot be reserved in advance, e.g. because the file system does not support it
+   */
+  virtual auto PreallocatePages(page_id_t first_page_id, size_t num_pages) -> bool;
+
+  /**
+   * Hint that a scan reached a page and will go on with the pages after it. DiskManager leaves read ahead to the
+   * operating system, disk managers that can do better override it.
+   * @param page_id id of the page
+   */
+  virtual void AdviseScan(page_id_t page_id) {}
+
+  /** @return true if the database file cannot be written, so that no page may be allocated or deallocated */
+  virtual auto IsReadOnly() const -> bool { return false; }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -83,6 +171,12 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of times the database file was synced */
+  auto GetNumSyncs() const -> int;
+
+  /** @return true if the database file is accessed with direct I/O */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -94,18 +188,32 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
-  // stream to write log file
-  std::fstream log_io_;
+  // write the changes of the free page map to the map file
+  void WriteFreeMap();
+  // descriptor of the log file, only appended to
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, only accessed with positional I/O so that it needs no latch
+  int db_fd_{-1};
   std::string file_name_;
-  int num_flushes_{0};
-  int num_writes_{0};
+  // true if db_fd_ was opened with O_DIRECT
+  bool direct_io_{false};
+  // descriptor of the free page map file
+  int free_map_fd_{-1};
+  std::string free_map_name_;
+  // file of the hot page list, only opened to replace or read the whole list
+  std::string hot_pages_name_;
+  // the free page map, a bit per page
+  std::vector<uint8_t> free_map_;
+  // the bytes [begin, end) of the free page map cover every change not written to the map file yet
+  size_t free_map_dirty_begin_{SIZE_MAX};
+  size_t free_map_dirty_end_{0};
+  std::mutex free_map_latch_;
+  std::atomic<int> num_flushes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<int> num_syncs_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
@@ -46,6 +46,13 @@ class DiskManagerMemory : public DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data) override;
 
+  /**
+   * Write a run of consecutive pages to the database file.
+   * @param first_page_id id of the first page
+   * @param pages raw data of the pages
+   */
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) override;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -53,6 +60,13 @@ class DiskManagerMemory : public DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data) override;
 
+  /**
+   * Read a run of consecutive pages from the database file.
+   * @param first_page_id id of the first page
+   * @param[out] pages output buffers
+   */
+  void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) override;
+
  private:
   char *memory_;
 };
@@ -89,6 +103,17 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
   }
 
+  /**
+   * Write a run of consecutive pages to the database file.
+   * @param first_page_id id of the first page
+   * @param pages raw data of the pages
+   */
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) override {
+    for (size_t i = 0; i < pages.size(); i++) {
+      WritePage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+  }
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -115,6 +140,32 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
   }
 
+  /**
+   * Read a run of consecutive pages from the database file.
+   * @param first_page_id id of the first page
+   * @param[out] pages output buffers
+   */
+  void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) override {
+    for (size_t i = 0; i < pages.size(); i++) {
+      ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+  }
+
+  /**
+   * Record whether a page is deallocated, and give the memory of deallocated pages back.
+   * @param page_id id of the page
+   * @param is_free true if the page was deallocated, false if it is in use again
+   */
+  void SetPageFree(page_id_t page_id, bool is_free) override {
+    DiskManager::SetPageFree(page_id, is_free);
+    if (is_free) {
+      std::scoped_lock<std::mutex> l(mutex_);
+      if (page_id < static_cast<int>(data_.size())) {
+        data_[page_id] = nullptr;
+      }
+    }
+  }
+
   void SetLatency(size_t latency_ms) { latency_ = latency_ms; }
 
  private:
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap serves a database file read-only, e.g. for reporting copies of a database. The file is mapped into
+ * memory once, and a page is read with a plain copy out of the mapping, without a system call per page. Pages past the
+ * end of the file read as zeros, as with DiskManager.
+ *
+ * Scans tell the disk manager where they are through AdviseScan(), which it turns into madvise() hints: the window of
+ * MMAP_READAHEAD_PAGES pages ahead of the scan is marked as sequential and needed soon, so that the operating system
+ * reads it ahead.
+ *
+ * Writes are refused with an exception, as are changes to the free page map; a buffer pool on top of this disk
+ * manager must never dirty a page, and refuses to create or delete pages since IsReadOnly() tells it so. No log, free
+ * page map or hot page list is opened or created next to the file.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * Map an existing database file.
+   * @param db_file the file name of the database file to read from
+   */
+  explicit DiskManagerMmap(const std::string &db_file);
+
+  ~DiskManagerMmap() override;
+
+  /** Refused, the database file is read-only. */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** Refused, the database file is read-only. */
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) override;
+
+  /**
+   * Read a page from the mapping.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Read a run of consecutive pages from the mapping.
+   * @param first_page_id id of the first page
+   * @param[out] pages output buffers
+   */
+  void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) override;
+
+  /** Refused, the database file is read-only. */
+  void SetPageFree(page_id_t page_id, bool is_free) override;
+
+  /** Refused, the database file is read-only. */
+  void SetPagesFree(page_id_t first_page_id, page_id_t num_pages) override;
+
+  /** @return false, the database file is read-only */
+  auto PreallocatePages(page_id_t first_page_id, size_t num_pages) -> bool override;
+
+  /** Advise the operating system to read ahead of a scan that reached a page. */
+  void AdviseScan(page_id_t page_id) override;
+
+  /** @return true, the database file is read-only */
+  auto IsReadOnly() const -> bool override { return true; }
+
+ private:
+  /** Start of the mapping, nullptr if the file is empty. */
+  char *data_{nullptr};
+  /** Size of the file and of the mapping, in bytes. */
+  size_t size_{0};
+  /** First page past the window last advised for read ahead. */
+  std::atomic<page_id_t> advised_end_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a Write or Read request for the DiskManager to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /**
+   *  Pointer to the start of the memory location where a page is either:
+   *   1. being read into from disk (on a read).
+   *   2. being written out to disk (on a write).
+   */
+  char *data_;
+
+  /** ID of the page being read from / written to disk. */
+  page_id_t page_id_;
+
+  /** Fulfilled with true once the request has been completed, or with false if the disk manager failed it. */
+  std::promise<bool> callback_;
+
+  /**
+   * Optional, invoked on the worker thread once the request has been completed, before `callback_` is fulfilled, with
+   * the value `callback_` is fulfilled with.
+   */
+  std::function<void(bool)> on_complete_;
+};
+
+/**
+ * @brief The DiskScheduler schedules disk read and write operations.
+ *
+ * A request is scheduled by calling DiskScheduler::Schedule() with an appropriate DiskRequest object. The scheduler
+ * maintains a queue of requests that is drained by a pool of background workers, so that a caller only blocks if it
+ * waits for the future of its request, and independent requests are executed in parallel. Requests on the same page
+ * are executed one at a time in the order they were scheduled: a worker skips the requests on pages that another
+ * worker is executing a request on. When a worker picks up a write, it also takes the writes queued right behind it
+ * that continue the same run of pages and hands them to the disk manager as a single contiguous write.
+ */
+class DiskScheduler {
+ public:
+  using DiskSchedulerPromise = std::promise<bool>;
+
+  /**
+   * @brief Creates a new DiskScheduler and starts its workers.
+   * @param disk_manager the disk manager executing the requests
+   * @param num_workers the number of background workers
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_NUM_WORKERS);
+
+  /** @brief Executes the requests that are still queued and stops the workers. */
+  ~DiskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(DiskScheduler);
+
+  /**
+   * @brief Schedules a request for the DiskManager to execute.
+   * @param r The request to be scheduled.
+   */
+  void Schedule(DiskRequest r);
+
+  /**
+   * @brief Schedules several requests at once. They are queued back to back, so writes of consecutive pages given in
+   * page id order are merged, and the merged runs are picked up by different workers in parallel.
+   * @param requests The requests to be scheduled.
+   */
+  void Schedule(std::vector<DiskRequest> requests);
+
+  /**
+   * @brief Create a Promise object. If you want to implement your own version of promise, you can change this function
+   * so that our test cases can use your promise implementation.
+   * @return std::promise<bool>
+   */
+  auto CreatePromise() -> DiskSchedulerPromise { return {}; };
+
+  /**
+   * @brief Schedules a request and returns the future of its completion.
+   * @param is_write true to write the page, false to read it
+   * @param page_id the page to read or write
+   * @param data the page buffer, which has to stay valid until the request completes
+   * @return the future of the request
+   */
+  auto ScheduleIo(bool is_write, page_id_t page_id, char *data) -> std::future<bool>;
+
+  /** @return the disk manager executing the requests */
+  auto GetDiskManager() -> DiskManager * { return disk_manager_; }
+
+ private:
+  /** The maximum number of page writes merged into a single disk manager call. */
+  static constexpr size_t MAX_COALESCED_WRITES = 32;
+
+  /** The loop run by every worker, until the scheduler is destroyed and the queue is empty. */
+  void WorkerLoop();
+
+  /**
+   * @brief Wait for the next request whose page no other worker is on, together with the writes that continue it, and
+   * mark their pages as in flight.
+   * @param[out] batch the requests to execute, ordered by page id
+   * @return false if the scheduler is shutting down and there is nothing left to do
+   */
+  auto NextBatch(std::vector<DiskRequest> *batch) -> bool;
+
+  /** Executes a batch returned by NextBatch() and completes its requests. */
+  void Execute(std::vector<DiskRequest> *batch);
+
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_;
+  /** Requests that have not been picked up by a worker yet. */
+  std::deque<DiskRequest> request_queue_;
+  /** Pages with a request being executed by a worker. */
+  std::unordered_set<page_id_t> in_flight_;
+  /** Protects the request queue, the pages in flight and the shutdown flag. */
+  std::mutex latch_;
+  /** Signalled when a request is queued or the scheduler shuts down. */
+  std::condition_variable queue_cv_;
+  /** Set by the destructor. */
+  bool shutdown_{false};
+  /** The background workers. */
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
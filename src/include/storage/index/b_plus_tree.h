@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <deque>
+#include <functional>
 #include <iostream>
 #include <optional>
 #include <queue>
@@ -58,6 +59,9 @@ class Context {
 
   std::deque<page_id_t> page_id_set_;
 
+  // Pages unlinked from the tree by merges, to be deleted once every latch is released.
+  std::deque<page_id_t> deleted_page_set_;
+
   std::deque<int> index_set_;
 
   auto IsRootPage(page_id_t page_id) -> bool { return page_id == root_page_id_; }
@@ -84,9 +88,25 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *txn);
 
+  /**
+   * @brief Build an empty tree bottom up from pairs in ascending key order, instead of inserting them one by one
+   *
+   * @param next yields the next pair, false once there are none left; of pairs with the same key the first is kept
+   * @param fill_percent how full the pages are made, never less than half full, so that inserts find room
+   * @return false if the tree is not empty; throws OUT_OF_MEMORY, leaving the tree empty, if the buffer pool runs out
+   * of frames
+   */
+  auto BulkLoad(const std::function<bool(MappingType *)> &next, int fill_percent = INDEX_BULK_LOAD_FILL_PERCENT)
+      -> bool;
+
  private:
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
   auto BinarySearch(const InternalPage *interanl_page, const KeyType &key) const -> int;
 
+  /** Search the first size slots of an internal page, for a size that was not read under the latch of the page */
+  auto BinarySearch(const InternalPage *interanl_page, const KeyType &key, int size) const -> int;
+
   auto BinarySearch(const LeafPage *leaf_page, const KeyType &key) const -> int;
 
   // Find leaf Node start from header node
@@ -94,6 +114,46 @@ class BPlusTree {
   auto InsertOptimal(const KeyType &key, Context *ctx) -> void;
   auto RemoveOptimal(const KeyType &key, Context *ctx) -> void;
   auto FindLeafNodeRead(const KeyType &key, Context *ctx) const -> void;
+
+  /**
+   * Find the first key within a lower bound.
+   * @param lower the lower bound, nullptr for the first key of the tree
+   * @param[out] leaf_pin the leaf the search ended in, pinned
+   * @return the position of the key in that leaf, which is the size of the leaf if the key is in the next one, or -1
+   * if the tree is empty
+   */
+  auto SeekFirst(const IndexKeyBound<KeyType> *lower, BasicPageGuard *leaf_pin) const -> int;
+
+  /**
+   * Find the last key within an upper bound.
+   * @param upper the upper bound, nullptr for the last key of the tree
+   * @param[out] leaf_pin the leaf holding the key, pinned
+   * @return the position of the key in that leaf, or -1 if there is no such key
+   */
+  auto SeekLast(const IndexKeyBound<KeyType> *upper, BasicPageGuard *leaf_pin) const -> int;
+  /**
+   * @brief Descend to a leaf without latching the inner pages, restarting whenever a page changed under the reader
+   *
+   * @param key the key to look for, or nullptr to reach the leftmost leaf
+   * @param[out] leaf_guard the read guard of the leaf
+   * @param[out] leaf_write_guard if not nullptr, the leaf is latched for writing into it instead of into leaf_guard
+   * @return false if the tree is empty
+   */
+  auto FindLeafOptimistic(const KeyType *key, ReadPageGuard *leaf_guard, WritePageGuard *leaf_write_guard = nullptr)
+      const -> bool;
+  /**
+   * @brief Insert into the leaf alone, found without latching the header or inner pages
+   *
+   * @param[out] inserted false if the key was already in the tree
+   * @return false if the leaf is full, or the tree empty, and the insert has to latch the path from the header
+   */
+  auto InsertIntoLeafOptimistic(const KeyType &key, const ValueType &value, bool *inserted) -> bool;
+  /**
+   * @brief Remove from the leaf alone, found without latching the header or inner pages
+   *
+   * @return false if the leaf would underflow, and the remove has to latch the path from the header
+   */
+  auto RemoveFromLeafOptimistic(const KeyType &key) -> bool;
   // auto InsertData2Internal(const int pos, InternalPage * internal_page, const MappingType &x) -> bool;
 
   /**
@@ -108,9 +168,17 @@ class BPlusTree {
   auto SplitLeaf(LeafPage *leaf_page, const KeyType &key, const ValueType &value)
       -> std::optional<std::pair<KeyType, page_id_t>>;
 
-  auto MergeInternal(InternalPage *internal_page, InternalPage *father_internal_page, int father_page_index) -> int;
+  /**
+   * @param[out] merged_page_id the sibling or internal page that was emptied by the merge
+   * @return the index of the merged page in the father page
+   */
+  auto MergeInternal(InternalPage *internal_page, InternalPage *father_internal_page, int father_page_index,
+                     page_id_t *merged_page_id) -> int;
 
-  auto MergeLeaf(LeafPage *leaf_page, InternalPage *father_internal_page, int father_page_index) -> bool;
+  /**
+   * @return the id of the leaf page that was emptied by the merge, either leaf_page or its right sibling
+   */
+  auto MergeLeaf(LeafPage *leaf_page, InternalPage *father_internal_page, int father_page_index) -> page_id_t;
 
   /**
    * @brief We steal from the right sibling mainly for the reason that this operation can reduce the number of key-value
@@ -144,6 +212,12 @@ class BPlusTree {
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  // Let lookups and iterators read inner pages without latching them, validating page versions instead
+  void SetOptimisticReads(bool optimistic_reads) { optimistic_reads_ = optimistic_reads; }
+
+  // Let inserts and removes that stay within one leaf latch only that leaf, validating page versions on the way down
+  void SetOptimisticWrites(bool optimistic_writes) { optimistic_writes_ = optimistic_writes; }
+
   // Index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
 
@@ -155,6 +229,11 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  // Iterator over the keys within a lower and an upper bound, either of which may be missing, in ascending order or
+  // in descending order if reverse
+  auto Range(const std::optional<IndexKeyBound<KeyType>> &lower, const std::optional<IndexKeyBound<KeyType>> &upper,
+             bool reverse = false) const -> INDEXITERATOR_TYPE;
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -219,6 +298,10 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  bool optimistic_reads_{false};
+  bool optimistic_writes_{false};
+  // the nodes of the tree are taken from its own extents, so that the leaves of a range scan are close on disk
+  PageExtent extent_;
   // INDEXITERATOR_TYPE iterator_;
 };
 
@@ -11,8 +11,10 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -35,28 +37,53 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Fill the index, which must be empty, with entries in any order. They are sorted, through the buffer pool if they
+   * do not fit into EXTERNAL_SORT_MEMORY, and the tree is built bottom up rather than by inserting them one by one.
+   * Of entries with the same key only the first one is kept, as with InsertEntry().
+   * @param next yields the next key and RID, false once there are none left
+   * @param fill_percent how full the pages of the tree are made
+   * @return false if the index is not empty; throws OUT_OF_MEMORY, leaving the index empty, if the buffer pool runs
+   * out of frames
+   */
+  auto BulkLoad(const std::function<bool(Tuple *, RID *)> &next, int fill_percent = INDEX_BULK_LOAD_FILL_PERCENT)
+      -> bool;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  /** @return an iterator over the keys within the bounds that are given, in descending order if reverse */
+  auto GetRangeIterator(const std::optional<IndexKeyBound<KeyType>> &lower,
+                        const std::optional<IndexKeyBound<KeyType>> &upper, bool reverse = false) -> INDEXITERATOR_TYPE;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
+  // buffer pool of the tree, also holds the sorted runs of a bulk load
+  BufferPoolManager *bpm_;
   // container
   std::shared_ptr<BPlusTree<KeyType, ValueType, KeyComparator>> container_;
 };
 
-/** We only support index table with one integer key for now in BusTub. Hardcode everything here. */
+/**
+ * We only support index table with one integer key for now in BusTub. Hardcode everything here. The comparator is
+ * chosen from the key schema when the index is created: keys IntegerComparatorType::CanCompare() are compared without
+ * going through Values, any other key by GenericComparatorType.
+ */
 
 constexpr static const auto TWO_INTEGER_SIZE = 8;
 using IntegerKeyType = GenericKey<TWO_INTEGER_SIZE>;
 using IntegerValueType = RID;
-using IntegerComparatorType = GenericComparator<TWO_INTEGER_SIZE>;
+using IntegerComparatorType = IntegerComparator<TWO_INTEGER_SIZE>;
+using GenericComparatorType = GenericComparator<TWO_INTEGER_SIZE>;
 using BPlusTreeIndexForTwoIntegerColumn = BPlusTreeIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
 using BPlusTreeIndexIteratorForTwoIntegerColumn =
     IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
+using BPlusTreeIndexForTwoColumn = BPlusTreeIndex<IntegerKeyType, IntegerValueType, GenericComparatorType>;
+using BPlusTreeIndexIteratorForTwoColumn = IndexIterator<IntegerKeyType, IntegerValueType, GenericComparatorType>;
 using IntegerHashFunctionType = HashFunction<IntegerKeyType>;
 
 }  // namespace bustub
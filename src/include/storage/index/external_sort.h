@@ -0,0 +1,316 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/exception.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+/**
+ * ExternalSorter sorts key value pairs that may not fit into memory, e.g. the entries of an index that is bulk loaded.
+ *
+ * Pairs are collected in a buffer of a fixed memory budget. Whenever the buffer is full, it is sorted and written as a
+ * run to temporary pages of the buffer pool. Finish() merges the runs, at most EXTERNAL_SORT_MERGE_FANIN at a time, in
+ * as many passes as it takes; the last merge is not written back but handed out pair by pair through Next(). A sort
+ * that fits into the budget never touches the buffer pool, and the temporary pages are deleted with the sorter. If the
+ * buffer pool has no frame left for a run, Add(), Finish() and Next() throw OUT_OF_MEMORY; the pages written so far
+ * are still deleted with the sorter.
+ *
+ * The sort is stable: pairs with equal keys come out in the order they were added.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExternalSorter {
+ public:
+  using Pair = std::pair<KeyType, ValueType>;
+
+  /** Pairs per run page, behind the number of pairs on the page. */
+  static constexpr size_t PAIRS_PER_PAGE = (BUSTUB_PAGE_SIZE - sizeof(uint32_t)) / sizeof(Pair);
+
+  /**
+   * Create a new ExternalSorter.
+   * @param bpm the buffer pool the runs are written to
+   * @param comparator the order of the keys
+   * @param memory_budget the memory the pairs may take before they are spilled, in bytes
+   */
+  ExternalSorter(BufferPoolManager *bpm, const KeyComparator &comparator, size_t memory_budget = EXTERNAL_SORT_MEMORY)
+      : bpm_(bpm), comparator_(comparator), run_capacity_(std::max(PAIRS_PER_PAGE, memory_budget / sizeof(Pair))) {}
+
+  ExternalSorter(const ExternalSorter &) = delete;
+  auto operator=(const ExternalSorter &) -> ExternalSorter & = delete;
+
+  ~ExternalSorter() {
+    merger_.reset();
+    for (auto &run : runs_) {
+      DeleteRun(run);
+    }
+  }
+
+  /** Add a pair. Must not be called after Finish(). */
+  void Add(const KeyType &key, const ValueType &value) {
+    buffer_.emplace_back(key, value);
+    if (buffer_.size() >= run_capacity_) {
+      Spill();
+    }
+  }
+
+  /** Sort what was added, so that Next() can hand it out. */
+  void Finish() {
+    if (runs_.empty()) {
+      std::stable_sort(buffer_.begin(), buffer_.end(), [this](const Pair &a, const Pair &b) { return Less(a, b); });
+      return;
+    }
+    if (!buffer_.empty()) {
+      Spill();
+    }
+    buffer_.shrink_to_fit();
+
+    while (runs_.size() > static_cast<size_t>(EXTERNAL_SORT_MERGE_FANIN)) {
+      std::vector<Run> merged;
+      try {
+        for (size_t begin = 0; begin < runs_.size(); begin += EXTERNAL_SORT_MERGE_FANIN) {
+          size_t end = std::min(runs_.size(), begin + EXTERNAL_SORT_MERGE_FANIN);
+          if (end - begin == 1) {
+            merged.push_back(std::move(runs_[begin]));
+            runs_[begin].clear();
+            continue;
+          }
+          {
+            Merger merger(this, runs_.begin() + begin, runs_.begin() + end);
+            RunWriter writer(bpm_);
+            Pair pair;
+            while (merger.Next(&pair)) {
+              writer.Append(pair);
+            }
+            merged.push_back(writer.Finish());
+          }
+          for (size_t i = begin; i < end; ++i) {
+            DeleteRun(runs_[i]);
+            runs_[i].clear();
+          }
+        }
+      } catch (const Exception &e) {
+        // the runs not merged yet are still in runs_, and deleted with the sorter
+        for (auto &run : merged) {
+          DeleteRun(run);
+        }
+        throw;
+      }
+      runs_ = std::move(merged);
+    }
+    merger_ = std::make_unique<Merger>(this, runs_.begin(), runs_.end());
+  }
+
+  /**
+   * @param[out] pair the next pair in key order
+   * @return false once all pairs were handed out
+   */
+  auto Next(Pair *pair) -> bool {
+    if (merger_ != nullptr) {
+      return merger_->Next(pair);
+    }
+    if (next_ == buffer_.size()) {
+      return false;
+    }
+    *pair = buffer_[next_++];
+    return true;
+  }
+
+  /** @return the number of runs spilled to the buffer pool, 0 if the sort fit into memory */
+  auto NumSpilledRuns() const -> size_t { return num_spilled_runs_; }
+
+ private:
+  /** The pages of a run, in order. */
+  using Run = std::vector<page_id_t>;
+
+  /** Appends pairs to the pages of a new run. */
+  class RunWriter {
+   public:
+    explicit RunWriter(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+    /** A run that was not finished, since the buffer pool ran out of frames, is deleted again. */
+    ~RunWriter() {
+      guard_.Drop();
+      for (auto page_id : run_) {
+        bpm_->DeletePage(page_id);
+      }
+    }
+
+    void Append(const Pair &pair) {
+      if (!has_page_ || count_ == PAIRS_PER_PAGE) {
+        FinishPage();
+        page_id_t page_id;
+        Page *page = bpm_->NewPage(&page_id);
+        if (page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for a sorted run");
+        }
+        guard_ = BasicPageGuard(bpm_, page);
+        has_page_ = true;
+        run_.push_back(page_id);
+      }
+      memcpy(guard_.GetDataMut() + sizeof(uint32_t) + count_ * sizeof(Pair), static_cast<const void *>(&pair),
+             sizeof(Pair));
+      count_++;
+    }
+
+    auto Finish() -> Run {
+      FinishPage();
+      Run run = std::move(run_);
+      run_.clear();
+      return run;
+    }
+
+   private:
+    void FinishPage() {
+      if (has_page_) {
+        memcpy(guard_.GetDataMut(), &count_, sizeof(count_));
+        guard_.Drop();
+        has_page_ = false;
+      }
+      count_ = 0;
+    }
+
+    BufferPoolManager *bpm_;
+    BasicPageGuard guard_;
+    bool has_page_{false};
+    uint32_t count_{0};
+    Run run_;
+  };
+
+  /** Reads the pairs of a run back, holding only its current page. */
+  class RunReader {
+   public:
+    RunReader(BufferPoolManager *bpm, const Run *run) : bpm_(bpm), run_(run) {}
+
+    auto Next(Pair *pair) -> bool {
+      while (pos_ == count_) {
+        if (next_page_ == run_->size()) {
+          guard_.Drop();
+          return false;
+        }
+        Page *page = bpm_->FetchPage((*run_)[next_page_++], AccessType::Scan);
+        if (page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to merge a sorted run");
+        }
+        page->RLatch();
+        guard_ = ReadPageGuard(bpm_, page);
+        memcpy(&count_, guard_.GetData(), sizeof(count_));
+        pos_ = 0;
+      }
+      memcpy(static_cast<void *>(pair), guard_.GetData() + sizeof(uint32_t) + pos_ * sizeof(Pair), sizeof(Pair));
+      pos_++;
+      return true;
+    }
+
+   private:
+    BufferPoolManager *bpm_;
+    const Run *run_;
+    size_t next_page_{0};
+    ReadPageGuard guard_;
+    uint32_t count_{0};
+    uint32_t pos_{0};
+  };
+
+  /** Merges runs through a heap of their next pairs; of equal keys, the pair of the earlier run comes first. */
+  class Merger {
+   public:
+    Merger(const ExternalSorter *sorter, typename std::vector<Run>::const_iterator begin,
+           typename std::vector<Run>::const_iterator end)
+        : sorter_(sorter) {
+      readers_.reserve(end - begin);
+      for (auto it = begin; it != end; ++it) {
+        readers_.emplace_back(sorter->bpm_, &*it);
+      }
+      heads_.resize(readers_.size());
+      for (size_t i = 0; i < readers_.size(); ++i) {
+        if (readers_[i].Next(&heads_[i])) {
+          heap_.push_back(i);
+          std::push_heap(heap_.begin(), heap_.end(), Greater());
+        }
+      }
+    }
+
+    auto Next(Pair *pair) -> bool {
+      if (heap_.empty()) {
+        return false;
+      }
+      std::pop_heap(heap_.begin(), heap_.end(), Greater());
+      size_t i = heap_.back();
+      *pair = heads_[i];
+      if (readers_[i].Next(&heads_[i])) {
+        std::push_heap(heap_.begin(), heap_.end(), Greater());
+      } else {
+        heap_.pop_back();
+      }
+      return true;
+    }
+
+   private:
+    auto Greater() const {
+      return [this](size_t a, size_t b) {
+        if (sorter_->Less(heads_[b], heads_[a])) {
+          return true;
+        }
+        return !sorter_->Less(heads_[a], heads_[b]) && a > b;
+      };
+    }
+
+    const ExternalSorter *sorter_;
+    std::vector<RunReader> readers_;
+    std::vector<Pair> heads_;
+    std::vector<size_t> heap_;
+  };
+
+  auto Less(const Pair &a, const Pair &b) const -> bool { return comparator_(a.first, b.first) < 0; }
+
+  /** Sort the buffer and write it out as a new run. */
+  void Spill() {
+    std::stable_sort(buffer_.begin(), buffer_.end(), [this](const Pair &a, const Pair &b) { return Less(a, b); });
+    RunWriter writer(bpm_);
+    for (const auto &pair : buffer_) {
+      writer.Append(pair);
+    }
+    runs_.push_back(writer.Finish());
+    buffer_.clear();
+    num_spilled_runs_++;
+  }
+
+  void DeleteRun(const Run &run) {
+    for (auto page_id : run) {
+      bpm_->DeletePage(page_id);
+    }
+  }
+
+  BufferPoolManager *bpm_;
+  KeyComparator comparator_;
+  /** Number of pairs buffered before they are spilled. */
+  const size_t run_capacity_;
+  std::vector<Pair> buffer_;
+  /** Position of the next pair in buffer_, if the sort fit into memory. */
+  size_t next_{0};
+  std::vector<Run> runs_;
+  size_t num_spilled_runs_{0};
+  /** The last merge, if runs were spilled. */
+  std::unique_ptr<Merger> merger_;
+};
+
+}  // namespace bustub
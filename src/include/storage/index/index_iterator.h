@@ -14,10 +14,23 @@
  */
 #pragma once
 // #include "storage/index/b_plus_tree.h"
+#include <optional>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/** A bound of a range of keys, which the range includes if inclusive_. */
+template <typename KeyType>
+struct IndexKeyBound {
+  KeyType key_;
+  bool inclusive_;
+};
+
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -26,7 +39,17 @@ class IndexIterator {  //  key value 在另外一页的问题
   // you may define your own constructor based on your member variables
   IndexIterator();
   IndexIterator(const IndexIterator &itr);
-  IndexIterator(BufferPoolManager *bpm, page_id_t current_page_id, int index);
+  IndexIterator(IndexIterator &&itr) noexcept = default;
+  IndexIterator(BufferPoolManager *bpm, page_id_t current_page_id, int index, bool optimistic = false);
+  /**
+   * An iterator over a range of keys, which starts at a position in a leaf. A position past the end of the leaf moves
+   * on to the next leaf.
+   * @param tree the tree the leaf belongs to, which a reverse iterator searches for the leaves it moves to
+   * @param reverse whether to move towards smaller keys
+   * @param stop the bound of the range the iterator moves towards, if any; the iterator ends past it
+   */
+  IndexIterator(const BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                page_id_t current_page_id, int index, bool reverse, std::optional<IndexKeyBound<KeyType>> stop);
 
   ~IndexIterator();  // NOLINT
 
@@ -38,20 +61,13 @@ class IndexIterator {  //  key value 在另外一页的问题
 
   auto operator==(const IndexIterator &itr) const -> bool {
     // KeyComparator key_comparator;
-    return itr.current_ == current_;
+    return itr.current_page_id_ == current_page_id_ && itr.index_ == index_;
     throw std::runtime_error("unimplemented");
   }
 
-  auto operator=(const IndexIterator &other) -> IndexIterator & {
-    if (this != &other) {
-      bpm_ = other.bpm_;
-      current_page_id_ = other.current_page_id_;
-      index_ = other.index_;
-      current_ = other.current_;
-      current_leaf_page_ = other.current_leaf_page_;
-    }
-    return *this;
-  }
+  auto operator=(const IndexIterator &other) -> IndexIterator &;
+
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator & = default;
 
   // auto operator==(IndexIterator &itr) const -> bool {
   //   // KeyComparator key_comparator;
@@ -60,18 +76,46 @@ class IndexIterator {  //  key value 在另外一页的问题
   // }
 
   auto operator!=(const IndexIterator &itr) const -> bool {
-    return itr.current_ != current_;
+    return !(*this == itr);
     throw std::runtime_error("unimplemented");
   }
 
  private:
+  /**
+   * Move to a position in a leaf page, and copy the pairs of the leaf, under its latch or validated against its
+   * version, instead of those of the previous one.
+   * @return the page id of the next leaf
+   */
+  auto LoadLeaf(page_id_t page_id, int index) -> page_id_t;
+
+  /** Move to the first pair of the next leaf, or to the end if there is none. */
+  void NextLeaf();
+
+  /** Move to the last pair of the leaf before the current one, or to the end if there is none. */
+  void PrevLeaf();
+
+  /** Move to the end if the current key is past the bound to stop at. */
+  void CheckStop();
+
+  void SetEnd();
+
   // add your own private member variables here
   // const B_PLUS_TREE_LEAF_PAGE_TYPE *current_leaf_page_;
   BufferPoolManager *bpm_;
   page_id_t current_page_id_;
   int index_;
   MappingType *current_;
-  const B_PLUS_TREE_LEAF_PAGE_TYPE *current_leaf_page_;
+  // The pairs of the current leaf, copied when the iterator moved to it, so that writers can change the leaf while it
+  // is being iterated; current_ points into it
+  std::vector<MappingType> entries_;
+  // The leaf that followed the current one when it was copied
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  // Read leaves without latching them, validating the page version instead
+  bool optimistic_{false};
+  // Set for iterators over a range, which move in either direction and end at a bound
+  const BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  bool reverse_{false};
+  std::optional<IndexKeyBound<KeyType>> stop_;
 };
 
 }  // namespace bustub
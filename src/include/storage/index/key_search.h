@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BUSTUB_KEY_SEARCH_AVX2
+#endif
+
+namespace bustub {
+
+/**
+ * Search kernels over the sorted keys of a B+ tree page, for keys of a single integer column. The keys lie in the
+ * array of the page between the values, stride bytes apart.
+ *
+ * CountNotGreater() halves the keys with conditional moves rather than branches, until at most KEY_SEARCH_WINDOW keys
+ * are left. Those are compared at once: gathered into AVX2 registers if the processor has them, or else in a plain
+ * loop without branches.
+ */
+class KeySearch {
+ public:
+  /** Number of keys left for the last step of a search, which compares them all. */
+  static constexpr size_t KEY_SEARCH_WINDOW = 16;
+
+  template <typename Int>
+  static auto ReadKey(const char *key) -> Int {
+    Int value;
+    memcpy(&value, key, sizeof(value));
+    return value;
+  }
+
+  /** @return how many of count ascending keys are not greater than key, compared one by one */
+  template <typename Int>
+  static auto CountWindowScalar(const char *first, size_t stride, size_t count, Int key) -> size_t {
+    size_t result = 0;
+    for (size_t i = 0; i < count; i++) {
+      result += static_cast<size_t>(ReadKey<Int>(first + i * stride) <= key);
+    }
+    return result;
+  }
+
+#ifdef BUSTUB_KEY_SEARCH_AVX2
+  /** @return whether the processor runs AVX2 instructions */
+  static auto HasAvx2() -> bool {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+  }
+
+  /** @return how many of count ascending keys are not greater than key, compared four at a time */
+  __attribute__((target("avx2"))) static auto CountWindowAvx2(const char *first, size_t stride, size_t count,
+                                                                int64_t key) -> size_t {
+    auto step = static_cast<int64_t>(stride);
+    const __m256i offsets = _mm256_setr_epi64x(0, step, 2 * step, 3 * step);
+    const __m256i probe = _mm256_set1_epi64x(key);
+    size_t greater = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m256i keys = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(first + i * stride),  // NOLINT
+                                            offsets, 1);
+      greater += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(keys, probe))));
+    }
+    return i - greater + CountWindowScalar(first + i * stride, stride, count - i, key);
+  }
+
+  /** @return how many of count ascending keys are not greater than key, compared eight at a time */
+  __attribute__((target("avx2"))) static auto CountWindowAvx2(const char *first, size_t stride, size_t count,
+                                                                int32_t key) -> size_t {
+    auto step = static_cast<int32_t>(stride);
+    const __m256i offsets = _mm256_setr_epi32(0, step, 2 * step, 3 * step, 4 * step, 5 * step, 6 * step, 7 * step);
+    const __m256i probe = _mm256_set1_epi32(key);
+    size_t greater = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      __m256i keys = _mm256_i32gather_epi32(reinterpret_cast<const int *>(first + i * stride), offsets, 1);
+      greater += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(keys, probe))));
+    }
+    return i - greater + CountWindowScalar(first + i * stride, stride, count - i, key);
+  }
+#else
+  static auto HasAvx2() -> bool { return false; }
+#endif
+
+  /**
+   * @param first the first key
+   * @param stride the distance between two keys, in bytes
+   * @param count the number of keys, in ascending order
+   * @param key the key to search for
+   * @param vectorized whether to compare the last keys with AVX2, which the processor must have
+   * @return how many of the keys are not greater than key
+   */
+  template <typename Int>
+  static auto CountNotGreater(const char *first, size_t stride, size_t count, Int key, bool vectorized = HasAvx2())
+      -> size_t {
+    size_t pos = 0;
+    while (count > KEY_SEARCH_WINDOW) {
+      size_t half = count / 2;
+      pos = ReadKey<Int>(first + (pos + half - 1) * stride) <= key ? pos + half : pos;
+      count -= half;
+    }
+    first += pos * stride;
+#ifdef BUSTUB_KEY_SEARCH_AVX2
+    if (vectorized) {
+      return pos + CountWindowAvx2(first, stride, count, key);
+    }
+#endif
+    return pos + CountWindowScalar(first, stride, count, key);
+  }
+};
+
+}  // namespace bustub
@@ -75,6 +75,8 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   auto ValueAt(int index) const -> ValueType;
 
+  auto GetMapPointorAt(int index) const -> const MappingType *;
+
   void SetMapAt(int index, const KeyType &key, const ValueType &value);
 
   void SetMapAt(int index, const MappingType &map);
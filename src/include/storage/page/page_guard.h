@@ -1,10 +1,14 @@
 #pragma once
 
+#include <utility>
+
 #include "storage/page/page.h"
 
 namespace bustub {
 
 class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
 
 class BasicPageGuard {
  public:
@@ -78,9 +82,17 @@ class BasicPageGuard {
     return reinterpret_cast<T *>(GetDataMut());
   }
 
+  /**
+   * @brief Latch the page for reading, keeping it pinned
+   *
+   * @return a ReadPageGuard holding the pin, this guard is empty afterwards
+   */
+  auto UpgradeRead() -> ReadPageGuard;
+
  private:
   friend class ReadPageGuard;
   friend class WritePageGuard;
+  friend class OptimisticReadGuard;
 
   BufferPoolManager *bpm_{nullptr};
   Page *page_{nullptr};
@@ -133,6 +145,13 @@ class ReadPageGuard {
    */
   ~ReadPageGuard();
 
+  /**
+   * @brief Release the read latch but keep the page pinned
+   *
+   * @return a BasicPageGuard holding the pin, this guard is empty afterwards
+   */
+  auto Downgrade() -> BasicPageGuard;
+
   auto PageId() -> page_id_t { return guard_.PageId(); }
 
   auto GetData() -> const char * { return guard_.GetData(); }
@@ -143,10 +162,71 @@ class ReadPageGuard {
   }
 
  private:
+  friend class BasicPageGuard;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
+/**
+ * OptimisticReadGuard pins a page without latching it. Readers copy what they need out of the page and then call
+ * Validate(): if a writer latched the page in between, what was read may be torn and has to be thrown away. Values
+ * read from the page must not be used to index into it, or be dereferenced, before they have been validated.
+ */
+class OptimisticReadGuard {
+ public:
+  OptimisticReadGuard() = default;
+  OptimisticReadGuard(BufferPoolManager *bpm, Page *page)
+      : guard_(bpm, page), version_(page == nullptr ? 0 : page->StableVersion()) {}
+  OptimisticReadGuard(const OptimisticReadGuard &) = delete;
+  auto operator=(const OptimisticReadGuard &) -> OptimisticReadGuard & = delete;
+  OptimisticReadGuard(OptimisticReadGuard &&that) noexcept = default;
+  auto operator=(OptimisticReadGuard &&that) noexcept -> OptimisticReadGuard & = default;
+  ~OptimisticReadGuard() = default;
+
+  /** Unpin the page. */
+  void Drop() { guard_.Drop(); }
+
+  /** @return true if the page was not latched for writing since the guard was created or last restarted */
+  auto Validate() const -> bool { return guard_.page_->ValidateVersion(version_); }
+
+  /** Wait for the current writer, if any, and start reading the page again. */
+  void Restart() { version_ = guard_.page_->StableVersion(); }
+
+  /**
+   * Turn this guard into a read guard, as long as the page did not change since the guard was created. This guard is
+   * empty afterwards, whether the upgrade succeeded or not.
+   * @param[out] read_guard the read guard, holding the pin of this guard
+   * @return false if a writer latched the page in the meantime
+   */
+  auto UpgradeRead(ReadPageGuard *read_guard) -> bool;
+
+  /**
+   * Turn this guard into a write guard, as long as the page did not change since the guard was created. This guard is
+   * empty afterwards, whether the upgrade succeeded or not.
+   * @param[out] write_guard the write guard, holding the pin of this guard
+   * @return false if another writer latched the page in the meantime
+   */
+  auto UpgradeWrite(WritePageGuard *write_guard) -> bool;
+
+  /** @return a BasicPageGuard holding the pin of this guard, which is empty afterwards */
+  auto Downgrade() -> BasicPageGuard { return std::move(guard_); }
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+  /** The page version the reads are validated against. */
+  uint64_t version_{0};
+};
+
 class WritePageGuard {
  public:
   WritePageGuard() = default;
@@ -0,0 +1,162 @@
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+namespace {
+
+/** A comparison of a column with a constant, as `column comp_type value`. */
+struct ColumnComparison {
+  uint32_t col_idx_;
+  ComparisonType comp_type_;
+  Value value_;
+};
+
+/** Collect the terms of a conjunction, e.g. of `a AND (b AND c)`. */
+void CollectConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    CollectConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    CollectConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+/** @return the term as a comparison of an integer column with a constant, with the column on the left */
+auto MatchColumnComparison(const AbstractExpressionRef &expr) -> std::optional<ColumnComparison> {
+  const auto *comparison_expr = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (comparison_expr == nullptr || comparison_expr->comp_type_ == ComparisonType::NotEqual) {
+    return std::nullopt;
+  }
+  auto comp_type = comparison_expr->comp_type_;
+  const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(comparison_expr->GetChildAt(0).get());
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(comparison_expr->GetChildAt(1).get());
+  if (column_expr == nullptr) {
+    // `value < column` is `column > value`
+    column_expr = dynamic_cast<const ColumnValueExpression *>(comparison_expr->GetChildAt(1).get());
+    constant_expr = dynamic_cast<const ConstantValueExpression *>(comparison_expr->GetChildAt(0).get());
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  // the keys of indexes are integers, a constant of another type or NULL does not bound them
+  if (column_expr == nullptr || constant_expr == nullptr || column_expr->GetTupleIdx() != 0 ||
+      column_expr->GetReturnType() != TypeId::INTEGER || constant_expr->val_.GetTypeId() != TypeId::INTEGER ||
+      constant_expr->val_.IsNull()) {
+    return std::nullopt;
+  }
+  return ColumnComparison{column_expr->GetColIdx(), comp_type, constant_expr->val_};
+}
+
+/** Narrow a bound down to another one if that is tighter; a lower bound is tighter if greater, an upper if less. */
+void Tighten(std::optional<IndexScanBound> *bound, const IndexScanBound &other, bool lower) {
+  if (!bound->has_value()) {
+    *bound = other;
+    return;
+  }
+  const auto &value = (*bound)->value_;
+  CmpBool tighter = lower ? other.value_.CompareGreaterThan(value) : other.value_.CompareLessThan(value);
+  if (tighter == CmpBool::CmpTrue ||
+      (other.value_.CompareEquals(value) == CmpBool::CmpTrue && !other.inclusive_)) {
+    *bound = other;
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  // INSERT, DELETE and UPDATE change the indexes of their table while they read their child, an index scan below them
+  // would read the entries they add, or skip the entries moved around in the leaf it is in
+  if (plan->GetType() == PlanType::Insert || plan->GetType() == PlanType::Delete ||
+      plan->GetType() == PlanType::Update) {
+    return plan;
+  }
+
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(filter_plan.children_.size() == 1, "Filter should have exactly 1 child.");
+  if (filter_plan.GetChildPlan()->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*filter_plan.GetChildPlan());
+  if (seq_scan.filter_predicate_ != nullptr) {
+    return optimized_plan;
+  }
+
+  std::vector<AbstractExpressionRef> conjuncts;
+  CollectConjuncts(filter_plan.GetPredicate(), &conjuncts);
+  std::vector<ColumnComparison> comparisons;
+  for (const auto &conjunct : conjuncts) {
+    if (auto comparison = MatchColumnComparison(conjunct); comparison.has_value()) {
+      comparisons.push_back(std::move(*comparison));
+    }
+  }
+
+  // the first column compared with a constant that has an index of its own is the one to scan
+  for (const auto &comparison : comparisons) {
+    auto index = MatchIndex(seq_scan.table_name_, comparison.col_idx_);
+    if (!index.has_value()) {
+      continue;
+    }
+    std::optional<IndexScanBound> lower;
+    std::optional<IndexScanBound> upper;
+    for (const auto &[col_idx, comp_type, value] : comparisons) {
+      if (col_idx != comparison.col_idx_) {
+        continue;
+      }
+      if (comp_type == ComparisonType::Equal || comp_type == ComparisonType::GreaterThan ||
+          comp_type == ComparisonType::GreaterThanOrEqual) {
+        Tighten(&lower, IndexScanBound{value, comp_type != ComparisonType::GreaterThan}, true);
+      }
+      if (comp_type == ComparisonType::Equal || comp_type == ComparisonType::LessThan ||
+          comp_type == ComparisonType::LessThanOrEqual) {
+        Tighten(&upper, IndexScanBound{value, comp_type != ComparisonType::LessThan}, false);
+      }
+    }
+    // the filter stays on top of the scan for the terms the bounds do not cover
+    auto index_scan = std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, std::get<0>(*index),
+                                                          std::move(lower), std::move(upper), false);
+    return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, filter_plan.GetPredicate(),
+                                            std::move(index_scan));
+  }
+
+  return optimized_plan;
+}
+
+}  // namespace bustub
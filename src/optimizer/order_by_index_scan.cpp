@@ -33,9 +33,10 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
     const auto &order_bys = sort_plan.GetOrderBy();
 
     std::vector<uint32_t> order_by_column_ids;
+    // All order types are asc or default, or all are desc, which the index is scanned backwards for
+    bool reverse = !order_bys.empty() && order_bys[0].first == OrderByType::DESC;
     for (const auto &[order_type, expr] : order_bys) {
-      // Order type is asc or default
-      if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+      if (order_type == OrderByType::INVALID || (order_type == OrderByType::DESC) != reverse) {
         return optimized_plan;
       }
 
@@ -69,6 +70,10 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
             }
           }
           if (valid) {
+            if (reverse) {
+              return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_,
+                                                         std::nullopt, std::nullopt, true);
+            }
             return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
           }
         }
@@ -18,6 +18,9 @@ void CheckpointManager::BeginCheckpoint() {
   // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
   // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
   // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  buffer_pool_manager_->FlushAllPages();
+  // a crash restarts from the hot pages of the last checkpoint
+  buffer_pool_manager_->SaveHotPages();
 }
 
 void CheckpointManager::EndCheckpoint() {
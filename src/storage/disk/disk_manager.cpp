@@ -10,116 +10,459 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/**
+ * Write the whole buffer at the given offset, retrying on short writes
+ * @return: false on I/O error
+ */
+static auto PWriteAll(int fd, const char *data, size_t size, off_t offset) -> bool {
+  while (size > 0) {
+    ssize_t n = pwrite(fd, data, size, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    size -= n;
+    offset += n;
+  }
+  return true;
+}
+
+/**
+ * Read up to size bytes at the given offset, retrying on short reads
+ * @return: the number of bytes read, which is less than size only at the end of file, or -1 on I/O error
+ */
+static auto PReadAll(int fd, char *data, size_t size, off_t offset) -> ssize_t {
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t n = pread(fd, data + read_count, size - read_count, offset + read_count);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_count += n;
+  }
+  return static_cast<ssize_t>(read_count);
+}
+
+/**
+ * @return: true if a buffer can be used for direct I/O as is
+ */
+static auto IsAligned(const char *data) -> bool { return reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE == 0; }
+
+/**
+ * Allocate a page buffer for direct I/O
+ */
+static auto MakeBounceBuffer() -> std::unique_ptr<char, decltype(&std::free)> {
+  return {static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE)), &std::free};
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input direct_io: bypass the page cache for the database file
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  free_map_name_ = file_name_.substr(0, n) + ".fpm";
+  hot_pages_name_ = file_name_.substr(0, n) + ".hot";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
+  // create the files if they do not exist yet
+  log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+#ifdef O_DIRECT
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_DEBUG("direct I/O is not supported for the db file");
     }
+    direct_io_ = db_fd_ >= 0;
+  }
+#endif
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+    throw Exception("can't open db file");
+  }
+
+  free_map_fd_ = open(free_map_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (free_map_fd_ < 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+    close(log_fd_);
+    log_fd_ = -1;
+    throw Exception("can't open free page map file");
+  }
+  int free_map_size = GetFileSize(free_map_name_);
+  free_map_.resize(std::max(free_map_size, 0));
+  if (PReadAll(free_map_fd_, reinterpret_cast<char *>(free_map_.data()), free_map_.size(), 0) < 0) {
+    LOG_DEBUG("I/O error while reading free page map");
+    free_map_.clear();
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() { ShutDown(); }
+
 /**
- * Close all file streams
+ * Close all file descriptors
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
+  if (free_map_fd_ >= 0) {
+    WriteFreeMap();
+    close(free_map_fd_);
+    free_map_fd_ = -1;
+  }
+}
+
+/**
+ * Make the page writes durable
+ */
+void DiskManager::Sync() {
+  if (db_fd_ < 0) {
+    return;
+  }
+  num_syncs_ += 1;
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+  WriteFreeMap();
+  if (free_map_fd_ >= 0 && fdatasync(free_map_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing free page map");
   }
-  log_io_.close();
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
+  if (direct_io_ && !IsAligned(page_data)) {
+    auto bounce = MakeBounceBuffer();
+    memcpy(bounce.get(), page_data, BUSTUB_PAGE_SIZE);
+    if (!PWriteAll(db_fd_, bounce.get(), BUSTUB_PAGE_SIZE, offset)) {
+      throw Exception("I/O error while writing page " + std::to_string(page_id));
+    }
+    return;
+  }
   // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  if (!PWriteAll(db_fd_, page_data, BUSTUB_PAGE_SIZE, offset)) {
+    throw Exception("I/O error while writing page " + std::to_string(page_id));
+  }
+}
+
+/**
+ * Write a run of consecutive pages into disk file with vectored I/O
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) {
+  if (direct_io_ && !std::all_of(pages.begin(), pages.end(), IsAligned)) {
+    for (size_t i = 0; i < pages.size(); ++i) {
+      WritePage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  num_writes_ += static_cast<int>(pages.size());
+
+  size_t done = 0;
+  while (done < pages.size()) {
+    size_t count = std::min<size_t>(pages.size() - done, IOV_MAX);
+    std::vector<iovec> iov(count);
+    for (size_t i = 0; i < count; ++i) {
+      iov[i].iov_base = const_cast<char *>(pages[done + i]);  // NOLINT
+      iov[i].iov_len = BUSTUB_PAGE_SIZE;
+    }
+
+    off_t offset = static_cast<off_t>(first_page_id + done) * BUSTUB_PAGE_SIZE;
+    ssize_t n = pwritev(db_fd_, iov.data(), static_cast<int>(count), offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      throw Exception("I/O error while writing page " + std::to_string(first_page_id + done));
+    }
+
+    // a page that was only written in part is written again as a whole with the rest of the run, which keeps direct
+    // I/O aligned
+    done += static_cast<size_t>(n) / BUSTUB_PAGE_SIZE;
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
+  off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (direct_io_ && !IsAligned(page_data)) {
+    auto bounce = MakeBounceBuffer();
+    ReadPage(page_id, bounce.get());
+    memcpy(page_data, bounce.get(), BUSTUB_PAGE_SIZE);
+    return;
+  }
+  ssize_t read_count = PReadAll(db_fd_, page_data, BUSTUB_PAGE_SIZE, offset);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  // if file ends before reading BUSTUB_PAGE_SIZE
+  if (read_count < BUSTUB_PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+}
+
+/**
+ * Read a run of consecutive pages with vectored I/O, pages past the end of the file read as zeros
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) {
+  if (direct_io_ && !std::all_of(pages.begin(), pages.end(), IsAligned)) {
+    for (size_t i = 0; i < pages.size(); ++i) {
+      ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+    return;
+  }
+
+  size_t done = 0;
+  while (done < pages.size()) {
+    size_t count = std::min<size_t>(pages.size() - done, IOV_MAX);
+    std::vector<iovec> iov(count);
+    for (size_t i = 0; i < count; ++i) {
+      iov[i].iov_base = pages[done + i];
+      iov[i].iov_len = BUSTUB_PAGE_SIZE;
+    }
+
+    off_t offset = static_cast<off_t>(first_page_id + done) * BUSTUB_PAGE_SIZE;
+    ssize_t n = preadv(db_fd_, iov.data(), static_cast<int>(count), offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+
+    // a page that was only read in part is read again with the rest of the run, unless the file ends within it
+    size_t full_pages = static_cast<size_t>(n) / BUSTUB_PAGE_SIZE;
+    size_t partial = static_cast<size_t>(n) % BUSTUB_PAGE_SIZE;
+    done += full_pages;
+    if (n == 0 || full_pages == 0) {
+      if (partial != 0) {
+        memset(pages[done] + partial, 0, BUSTUB_PAGE_SIZE - partial);
+        done++;
+      }
+      for (; done < pages.size(); ++done) {
+        memset(pages[done], 0, BUSTUB_PAGE_SIZE);
+      }
+    }
+  }
+}
+
+/**
+ * Flip the bit of a page in the free page map, the byte holding it is written to the map file at the next sync
+ */
+void DiskManager::SetPageFree(page_id_t page_id, bool is_free) {
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  size_t byte = static_cast<size_t>(page_id) / 8;
+  auto mask = static_cast<uint8_t>(1U << (static_cast<size_t>(page_id) % 8));
+
+  std::scoped_lock<std::mutex> lock(free_map_latch_);
+  if (byte >= free_map_.size()) {
+    if (!is_free) {
+      return;
+    }
+    free_map_.resize(byte + 1, 0);
+  }
+  if (((free_map_[byte] & mask) != 0) == is_free) {
+    return;
+  }
+  free_map_[byte] ^= mask;
+  free_map_dirty_begin_ = std::min(free_map_dirty_begin_, byte);
+  free_map_dirty_end_ = std::max(free_map_dirty_end_, byte + 1);
+}
+
+/**
+ * Set the bits of a run of pages in the free page map, the bytes holding them are written at the next sync
+ */
+void DiskManager::SetPagesFree(page_id_t first_page_id, page_id_t num_pages) {
+  BUSTUB_ASSERT(first_page_id >= 0 && num_pages >= 0, "invalid page id");
+  if (num_pages == 0) {
+    return;
+  }
+  size_t first_byte = static_cast<size_t>(first_page_id) / 8;
+  size_t last_byte = static_cast<size_t>(first_page_id + num_pages - 1) / 8;
+
+  std::scoped_lock<std::mutex> lock(free_map_latch_);
+  if (last_byte >= free_map_.size()) {
+    free_map_.resize(last_byte + 1, 0);
+  }
+  for (page_id_t page_id = first_page_id; page_id < first_page_id + num_pages; page_id++) {
+    free_map_[static_cast<size_t>(page_id) / 8] |= static_cast<uint8_t>(1U << (static_cast<size_t>(page_id) % 8));
+  }
+  free_map_dirty_begin_ = std::min(free_map_dirty_begin_, first_byte);
+  free_map_dirty_end_ = std::max(free_map_dirty_end_, last_byte + 1);
+}
+
+/**
+ * Write the bytes of the free page map changed since the last time to the map file, with a single write
+ */
+void DiskManager::WriteFreeMap() {
+  std::scoped_lock<std::mutex> lock(free_map_latch_);
+  if (free_map_dirty_begin_ >= free_map_dirty_end_) {
+    return;
+  }
+  if (free_map_fd_ >= 0 &&
+      !PWriteAll(free_map_fd_, reinterpret_cast<const char *>(&free_map_[free_map_dirty_begin_]),
+                 free_map_dirty_end_ - free_map_dirty_begin_, static_cast<off_t>(free_map_dirty_begin_))) {
+    LOG_DEBUG("I/O error while writing free page map");
+  }
+  free_map_dirty_begin_ = SIZE_MAX;
+  free_map_dirty_end_ = 0;
+}
+
+/**
+ * Collect the pages whose bit is set in the free page map
+ */
+auto DiskManager::GetFreePages() -> std::vector<page_id_t> {
+  std::scoped_lock<std::mutex> lock(free_map_latch_);
+  std::vector<page_id_t> free_pages;
+  for (size_t byte = 0; byte < free_map_.size(); byte++) {
+    for (size_t bit = 0; bit < 8; bit++) {
+      if ((free_map_[byte] & (1U << bit)) != 0) {
+        free_pages.push_back(static_cast<page_id_t>(byte * 8 + bit));
+      }
     }
   }
+  return free_pages;
+}
+
+/**
+ * Write the hot page list to a new file, and move it over the old one
+ */
+void DiskManager::WriteHotPages(const std::vector<page_id_t> &page_ids) {
+  if (hot_pages_name_.empty()) {
+    return;
+  }
+  std::string tmp_name = hot_pages_name_ + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_DEBUG("can't open hot page list file");
+    return;
+  }
+  bool written = PWriteAll(fd, reinterpret_cast<const char *>(page_ids.data()), page_ids.size() * sizeof(page_id_t), 0);
+  written = written && fdatasync(fd) == 0;
+  close(fd);
+  if (!written || rename(tmp_name.c_str(), hot_pages_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while writing hot page list");
+    unlink(tmp_name.c_str());
+  }
+}
+
+/**
+ * Read the head of the hot page list
+ */
+auto DiskManager::ReadHotPages(size_t max_count) -> std::vector<page_id_t> {
+  if (hot_pages_name_.empty()) {
+    return {};
+  }
+  int fd = open(hot_pages_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return {};
+  }
+  std::vector<page_id_t> page_ids(max_count);
+  ssize_t n = PReadAll(fd, reinterpret_cast<char *>(page_ids.data()), max_count * sizeof(page_id_t), 0);
+  close(fd);
+  if (n < 0) {
+    LOG_DEBUG("I/O error while reading hot page list");
+    return {};
+  }
+  page_ids.resize(static_cast<size_t>(n) / sizeof(page_id_t));
+  return page_ids;
+}
+
+/**
+ * Returns the size of the db file in pages, rounded up
+ */
+auto DiskManager::GetNumPages() -> page_id_t {
+  if (db_fd_ < 0) {
+    return 0;
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    LOG_DEBUG("I/O error while getting the size of the db file");
+    return 0;
+  }
+  return static_cast<page_id_t>((stat_buf.st_size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
+}
+
+auto DiskManager::PreallocatePages(page_id_t first_page_id, size_t num_pages) -> bool {
+#ifdef __linux__
+  if (db_fd_ < 0) {
+    return false;
+  }
+  // keep the size, the number of pages of the file is the number of pages written
+  auto offset = static_cast<off_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  auto length = static_cast<off_t>(num_pages) * BUSTUB_PAGE_SIZE;
+  int ret;
+  do {
+    ret = fallocate(db_fd_, FALLOC_FL_KEEP_SIZE, offset, length);
+  } while (ret != 0 && errno == EINTR);
+  if (ret != 0 && errno != EOPNOTSUPP) {
+    LOG_DEBUG("I/O error while preallocating pages");
+  }
+  return ret == 0;
+#else
+  return false;
+#endif
 }
 
 /**
@@ -143,16 +486,16 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
+  // sequence write, the file is opened in append mode so the offset is ignored
+  if (!PWriteAll(log_fd_, log_data, size, 0)) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  // the log is forced at commit, it has to be durable before we return
+  if (fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+    return;
+  }
   flush_log_ = false;
 }
 
@@ -167,17 +510,14 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
 
-  if (log_io_.bad()) {
+  ssize_t read_count = PReadAll(log_fd_, log_data, size, offset);
+  if (read_count < 0) {
     LOG_DEBUG("I/O error while reading log");
     return false;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
@@ -194,6 +534,11 @@ auto DiskManager::GetNumFlushes() const -> int { return num_flushes_; }
  */
 auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
 
+/**
+ * Returns number of syncs of the db file made so far
+ */
+auto DiskManager::GetNumSyncs() const -> int { return num_syncs_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
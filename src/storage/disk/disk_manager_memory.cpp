@@ -39,6 +39,15 @@ void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
   memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Write the contents of the specified pages into disk file
+ */
+void DiskManagerMemory::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) {
+  for (size_t i = 0; i < pages.size(); i++) {
+    WritePage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+  }
+}
+
 /**
  * Read the contents of the specified page into the given memory area
  */
@@ -47,4 +56,13 @@ void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
   memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Read a run of consecutive pages into the given memory areas
+ */
+void DiskManagerMemory::ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) {
+  for (size_t i = 0; i < pages.size(); i++) {
+    ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+  }
+}
+
 }  // namespace bustub
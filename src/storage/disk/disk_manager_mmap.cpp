@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+/**
+ * Constructor: open the database file read-only and map all of it
+ */
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file) {
+  file_name_ = db_file;
+  db_fd_ = open(db_file.c_str(), O_RDONLY);
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    ShutDown();
+    throw Exception("can't get the size of the db file");
+  }
+  size_ = static_cast<size_t>(stat_buf.st_size);
+  // an empty file cannot be mapped, all of its pages read as zeros anyway
+  if (size_ == 0) {
+    return;
+  }
+  void *data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (data == MAP_FAILED) {
+    ShutDown();
+    throw Exception("can't map db file");
+  }
+  data_ = static_cast<char *>(data);
+}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+void DiskManagerMmap::WritePage(page_id_t page_id, const char *page_data) {
+  throw Exception("can't write page " + std::to_string(page_id) + ", the db file is mapped read-only");
+}
+
+void DiskManagerMmap::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) {
+  throw Exception("can't write page " + std::to_string(first_page_id) + ", the db file is mapped read-only");
+}
+
+/**
+ * Copy a page out of the mapping, the part of it past the end of the file reads as zeros
+ */
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  size_t read_count = offset < size_ ? std::min<size_t>(BUSTUB_PAGE_SIZE, size_ - offset) : 0;
+  if (read_count > 0) {
+    memcpy(page_data, data_ + offset, read_count);
+  }
+  if (read_count < BUSTUB_PAGE_SIZE) {
+    memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+}
+
+void DiskManagerMmap::ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) {
+  for (size_t i = 0; i < pages.size(); i++) {
+    ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+  }
+}
+
+void DiskManagerMmap::SetPageFree(page_id_t page_id, bool is_free) {
+  throw Exception("can't free page " + std::to_string(page_id) + ", the db file is mapped read-only");
+}
+
+void DiskManagerMmap::SetPagesFree(page_id_t first_page_id, page_id_t num_pages) {
+  throw Exception("can't free page " + std::to_string(first_page_id) + ", the db file is mapped read-only");
+}
+
+auto DiskManagerMmap::PreallocatePages(page_id_t first_page_id, size_t num_pages) -> bool { return false; }
+
+/**
+ * Advise the window of pages ahead of a scan, once the scan is halfway through the window advised before or has moved
+ * elsewhere, so that a scan costs a system call per half window rather than per page
+ */
+void DiskManagerMmap::AdviseScan(page_id_t page_id) {
+  page_id_t end = advised_end_.load();
+  if (data_ == nullptr || (page_id >= end - MMAP_READAHEAD_PAGES && page_id < end - MMAP_READAHEAD_PAGES / 2)) {
+    return;
+  }
+  advised_end_.store(page_id + MMAP_READAHEAD_PAGES);
+
+  // madvise() takes whole pages of the operating system, which may be larger than ours
+  auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t begin = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE / os_page_size * os_page_size;
+  if (begin >= size_) {
+    return;
+  }
+  size_t length = std::min<size_t>(size_ - begin, static_cast<size_t>(MMAP_READAHEAD_PAGES) * BUSTUB_PAGE_SIZE);
+  if (madvise(data_ + begin, length, MADV_SEQUENTIAL) != 0 || madvise(data_ + begin, length, MADV_WILLNEED) != 0) {
+    LOG_DEBUG("madvise failed on the db file");
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers) : disk_manager_(disk_manager) {
+  num_workers = std::max<size_t>(1, num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::lock_guard<std::mutex> l(latch_);
+    shutdown_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) {
+  {
+    std::lock_guard<std::mutex> l(latch_);
+    request_queue_.emplace_back(std::move(r));
+  }
+  queue_cv_.notify_one();
+}
+
+void DiskScheduler::Schedule(std::vector<DiskRequest> requests) {
+  {
+    std::lock_guard<std::mutex> l(latch_);
+    for (auto &r : requests) {
+      request_queue_.emplace_back(std::move(r));
+    }
+  }
+  queue_cv_.notify_all();
+}
+
+auto DiskScheduler::ScheduleIo(bool is_write, page_id_t page_id, char *data) -> std::future<bool> {
+  DiskRequest r;
+  r.is_write_ = is_write;
+  r.data_ = data;
+  r.page_id_ = page_id;
+  r.callback_ = CreatePromise();
+  auto future = r.callback_.get_future();
+  Schedule(std::move(r));
+  return future;
+}
+
+void DiskScheduler::WorkerLoop() {
+  std::vector<DiskRequest> batch;
+  std::vector<page_id_t> page_ids;
+  while (NextBatch(&batch)) {
+    for (auto &r : batch) {
+      page_ids.push_back(r.page_id_);
+    }
+    Execute(&batch);
+    batch.clear();
+
+    // the requests queued behind these pages may go now
+    {
+      std::lock_guard<std::mutex> l(latch_);
+      for (auto page_id : page_ids) {
+        in_flight_.erase(page_id);
+      }
+    }
+    page_ids.clear();
+    queue_cv_.notify_all();
+  }
+}
+
+auto DiskScheduler::NextBatch(std::vector<DiskRequest> *batch) -> bool {
+  std::unique_lock<std::mutex> l(latch_);
+  // the first request whose page is not being worked on by another worker; the ones before it wait for their page
+  auto next = request_queue_.end();
+  queue_cv_.wait(l, [&] {
+    next = std::find_if(request_queue_.begin(), request_queue_.end(),
+                        [&](const DiskRequest &r) { return in_flight_.count(r.page_id_) == 0; });
+    return next != request_queue_.end() || (shutdown_ && request_queue_.empty());
+  });
+  if (next == request_queue_.end()) {
+    return false;
+  }
+
+  batch->emplace_back(std::move(*next));
+  next = request_queue_.erase(next);
+  in_flight_.insert(batch->back().page_id_);
+  if (!batch->front().is_write_) {
+    return true;
+  }
+
+  // only the writes directly behind the first one are merged, and only if no other worker is on their page, so that
+  // requests on the same page never overtake each other
+  while (batch->size() < MAX_COALESCED_WRITES && next != request_queue_.end() && next->is_write_ &&
+         next->page_id_ == batch->back().page_id_ + 1 && in_flight_.count(next->page_id_) == 0) {
+    batch->emplace_back(std::move(*next));
+    next = request_queue_.erase(next);
+    in_flight_.insert(batch->back().page_id_);
+  }
+  return true;
+}
+
+void DiskScheduler::Execute(std::vector<DiskRequest> *batch) {
+  auto &first = batch->front();
+  bool done = true;
+  try {
+    if (!first.is_write_) {
+      disk_manager_->ReadPage(first.page_id_, first.data_);
+    } else if (batch->size() == 1) {
+      disk_manager_->WritePage(first.page_id_, first.data_);
+    } else {
+      std::vector<const char *> pages;
+      pages.reserve(batch->size());
+      for (auto &r : *batch) {
+        pages.push_back(r.data_);
+      }
+      disk_manager_->WritePages(first.page_id_, pages);
+    }
+  } catch (const std::exception &e) {
+    // e.g. a write to a read-only disk manager, or an I/O error, the worker has to survive it
+    LOG_DEBUG("disk request on page %d failed: %s", first.page_id_, e.what());
+    done = false;
+  }
+
+  for (auto &r : *batch) {
+    if (r.on_complete_) {
+      r.on_complete_(done);
+    }
+    r.callback_.set_value(done);
+  }
+}
+
+}  // namespace bustub
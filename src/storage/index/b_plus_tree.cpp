@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <fstream>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -10,6 +13,17 @@
 
 namespace bustub {
 
+namespace {
+
+/** Whether a comparator searches the keys of a page by itself, see IntegerComparator::CountNotGreater(). */
+template <typename Comparator, typename = void>
+struct HasPageSearch : std::false_type {};
+
+template <typename Comparator>
+struct HasPageSearch<Comparator, std::void_t<decltype(&Comparator::CountNotGreater)>> : std::true_type {};
+
+}  // namespace
+
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                           const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
@@ -40,9 +54,19 @@ auto BPLUSTREE_TYPE::BinarySearch(const InternalPage *interanl_page, const KeyTy
   if (interanl_page == nullptr) {
     return -1;
   }
+  return BinarySearch(interanl_page, key, interanl_page->GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BinarySearch(const InternalPage *interanl_page, const KeyType &key, int size) const -> int {
+  if constexpr (HasPageSearch<KeyComparator>::value) {
+    // of the keys from 1 on, the child of the last one not greater than key is the one to follow
+    return comparator_.CountNotGreater(reinterpret_cast<const char *>(&interanl_page->GetMapPointorAt(1)->first),
+                                       sizeof(std::pair<KeyType, page_id_t>), size - 1, key);
+  }
 
   int left = 1;
-  int right = interanl_page->GetSize() - 1;
+  int right = size - 1;
   int mid;
 
   if (comparator_(key, interanl_page->KeyAt(1)) == -1) {
@@ -69,6 +93,11 @@ auto BPLUSTREE_TYPE::BinarySearch(const LeafPage *leaf_page, const KeyType &key)
   if (leaf_page == nullptr) {
     return -2;
   }
+  if constexpr (HasPageSearch<KeyComparator>::value) {
+    return comparator_.CountNotGreater(reinterpret_cast<const char *>(&leaf_page->GetMapPointorAt(0)->first),
+                                       sizeof(MappingType), leaf_page->GetSize(), key) -
+           1;
+  }
   if (comparator_(leaf_page->KeyAt(0), key) == 1) {
     return -1;
   }
@@ -106,6 +135,20 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
     return false;
   }
 
+  if (optimistic_reads_) {
+    ReadPageGuard leaf_guard;
+    if (!FindLeafOptimistic(&key, &leaf_guard)) {
+      return false;
+    }
+    auto leaf_page = leaf_guard.template As<LeafPage>();
+    int index = BinarySearch(leaf_page, key);
+    if (index >= 0 && comparator_(leaf_page->KeyAt(index), key) == 0) {
+      result->emplace_back(leaf_page->ValueAt(index));
+      return true;
+    }
+    return false;
+  }
+
   auto header_guard = bpm_->FetchPageRead(header_page_id_);
   auto header_page = header_guard.As<BPlusTreeHeaderPage>();
 
@@ -116,7 +159,7 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   auto leaf_page = ctx.read_set_.back().template As<LeafPage>();
   int index = BinarySearch(leaf_page, key);
 
-  if (comparator_(leaf_page->KeyAt(index), key) == 0) {
+  if (index >= 0 && comparator_(leaf_page->KeyAt(index), key) == 0) {
     result->emplace_back(leaf_page->ValueAt(index));
     ctx.read_set_.back().Drop();
     ctx.read_set_.pop_back();
@@ -276,6 +319,97 @@ auto BPLUSTREE_TYPE::FindLeafNodeRead(const KeyType &key, Context *ctx) const ->
   }
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType *key, ReadPageGuard *leaf_guard,
+                                        WritePageGuard *leaf_write_guard) const -> bool {
+  while (true) {
+    // The header page plays the parent of the root: a new root is only published through it.
+    auto parent_guard = bpm_->FetchPageOptimistic(header_page_id_);
+    page_id_t page_id = parent_guard.template As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (!parent_guard.Validate()) {
+      continue;
+    }
+    if (page_id == INVALID_PAGE_ID) {
+      return false;
+    }
+
+    while (true) {
+      auto guard = bpm_->FetchPageOptimistic(page_id);
+      auto b_plus_tree_page = guard.template As<BPlusTreePage>();
+      bool is_leaf = b_plus_tree_page->IsLeafPage();
+      // If the parent changed, page_id may not be its child anymore, or not even a tree page.
+      if (!guard.Validate() || !parent_guard.Validate()) {
+        break;
+      }
+      if (is_leaf) {
+        if (leaf_write_guard != nullptr ? guard.UpgradeWrite(leaf_write_guard) : guard.UpgradeRead(leaf_guard)) {
+          return true;
+        }
+        break;
+      }
+
+      // A writer may be halfway through the page: its size is clamped, so that the search and the child it picks stay
+      // within the page, and the child is only followed once the version proves that it was read whole.
+      auto internal_page = reinterpret_cast<const InternalPage *>(b_plus_tree_page);
+      int size = std::clamp(internal_page->GetSize(), 0, internal_max_size_);
+      int index = key == nullptr || size == 0 ? 0 : BinarySearch(internal_page, *key, size);
+      page_id_t child_page_id = internal_page->ValueAt(index);
+      if (!guard.Validate()) {
+        break;
+      }
+      parent_guard = std::move(guard);
+      page_id = child_page_id;
+    }
+  }
+}
+
+/*
+ * A leaf that has room for one more key, or one key to spare, is changed without touching its parent: it is enough to
+ * latch the leaf itself, and the version of the leaf proves that it is still the one the parents lead to.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertIntoLeafOptimistic(const KeyType &key, const ValueType &value, bool *inserted) -> bool {
+  WritePageGuard leaf_guard;
+  if (!FindLeafOptimistic(&key, nullptr, &leaf_guard)) {
+    return false;
+  }
+  auto leaf_page = leaf_guard.template As<LeafPage>();
+  int index = BinarySearch(leaf_page, key);
+  if (index >= 0 && comparator_(leaf_page->KeyAt(index), key) == 0) {
+    *inserted = false;
+    return true;
+  }
+  if (leaf_page->GetSize() >= leaf_max_size_) {
+    return false;
+  }
+  leaf_guard.template AsMut<LeafPage>()->InsertMap2Leaf(index + 1, key, value);
+  *inserted = true;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveFromLeafOptimistic(const KeyType &key) -> bool {
+  WritePageGuard leaf_guard;
+  if (!FindLeafOptimistic(&key, nullptr, &leaf_guard)) {
+    return true;
+  }
+  auto leaf_page = leaf_guard.template As<LeafPage>();
+  int index = BinarySearch(leaf_page, key);
+  if (index < 0 || comparator_(leaf_page->KeyAt(index), key) != 0) {
+    return true;
+  }
+  if (leaf_page->GetSize() - 1 < leaf_page->GetMinSize()) {
+    return false;
+  }
+  auto leaf_page_mut = leaf_guard.template AsMut<LeafPage>();
+  int leaf_page_size = leaf_page_mut->GetSize();
+  for (int i = index; i < leaf_page_size - 1; i++) {
+    leaf_page_mut->Move(i + 1, i);
+  }
+  leaf_page_mut->SetSize(leaf_page_size - 1);
+  return true;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -293,6 +427,10 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   Context ctx;
   auto fs = std::fstream();
 
+  if (optimistic_writes_ && InsertIntoLeafOptimistic(key, value, &flag)) {
+    return flag;
+  }
+
   auto header_guard = bpm_->FetchPageWrite(header_page_id_);
   auto header_page = header_guard.AsMut<BPlusTreeHeaderPage>();
 
@@ -301,7 +439,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   ctx.root_page_id_ = header_page->root_page_id_;
 
   if (header_page->root_page_id_ == INVALID_PAGE_ID) {  // it is a empty tree
-    auto new_page_guard = bpm_->NewPageGuarded(&header_page->root_page_id_);
+    auto new_page_guard = bpm_->NewPageGuarded(&header_page->root_page_id_, &extent_);
     auto new_leaf = new_page_guard.AsMut<LeafPage>();
     new_page_guard.Drop();
 
@@ -331,7 +469,9 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 
     // if you try to reinsert an existing key into the index,
     // it should not perform the insertion, and should return false.
-    if (comparator_(leaf_page->KeyAt(BinarySearch(leaf_page, key)), key) == 0) {
+    // a key less than all keys of the leaf has index -1, which is not a slot of the leaf
+    int index = BinarySearch(leaf_page, key);
+    if (index >= 0 && comparator_(leaf_page->KeyAt(index), key) == 0) {
       // fs << "失败\n";
       return false;
     }
@@ -347,7 +487,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
       if (ctx.IsRootPage(leaf_page_guard.PageId())) {  // leaf page is the root page
         auto &header_guard1 = ctx.header_page_.value();
         header_page = header_guard1.AsMut<BPlusTreeHeaderPage>();
-        auto root_page_guard = bpm_->NewPageGuarded(&header_page->root_page_id_);
+        auto root_page_guard = bpm_->NewPageGuarded(&header_page->root_page_id_, &extent_);
         auto root_page = root_page_guard.AsMut<InternalPage>();
         ctx.root_page_id_ = header_page->root_page_id_;
         root_page_guard.Drop();
@@ -372,7 +512,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
         if (ctx.write_set_.empty() && optional.has_value() && ctx.header_page_.has_value()) {  // root page is split
           auto &header_guard1 = ctx.header_page_.value();
           header_page = header_guard1.AsMut<BPlusTreeHeaderPage>();
-          auto root_page_guard = bpm_->NewPageGuarded(&header_page->root_page_id_);
+          auto root_page_guard = bpm_->NewPageGuarded(&header_page->root_page_id_, &extent_);
           auto root_page = root_page_guard.AsMut<InternalPage>();
 
           ctx.root_page_id_ = header_page->root_page_id_;
@@ -413,7 +553,7 @@ auto BPLUSTREE_TYPE::SplitInternal(InternalPage *internal_page, std::pair<KeyTyp
 
   if (internal_page->GetSize() == internal_max_size_) {
     page_id_t second_page_id;
-    auto new_page_guard1 = bpm_->NewPageGuarded(&second_page_id);  // leak of 16672 byte(s)
+    auto new_page_guard1 = bpm_->NewPageGuarded(&second_page_id, &extent_);  // leak of 16672 byte(s)
     auto second_internal_page = new_page_guard1.AsMut<InternalPage>();
     new_page_guard1.Drop();
 
@@ -468,7 +608,7 @@ auto BPLUSTREE_TYPE::SplitLeaf(LeafPage *leaf_page, const KeyType &key, const Va
 
   if (leaf_page->GetSize() == leaf_max_size_) {
     page_id_t second_page_id;
-    auto new_page_guard1 = bpm_->NewPageGuarded(&second_page_id);
+    auto new_page_guard1 = bpm_->NewPageGuarded(&second_page_id, &extent_);
     auto second_leaf_page = new_page_guard1.AsMut<LeafPage>();
     new_page_guard1.Drop();
 
@@ -631,6 +771,153 @@ auto BPLUSTREE_TYPE::RemoveOptimal(const KeyType &key, Context *ctx) -> void {
   }
 }
 
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+/*
+ * Leaves are filled left to right and chained as they go. Every inner level is then built over the first keys and
+ * page ids of the level below, until a level fits into a single page, the root. The header page stays latched all
+ * along, so that the tree is published in one go.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::function<bool(MappingType *)> &next, int fill_percent) -> bool {
+  auto header_guard = bpm_->FetchPageWrite(header_page_id_);
+  auto header_page = header_guard.AsMut<BPlusTreeHeaderPage>();
+  if (header_page->root_page_id_ != INVALID_PAGE_ID) {
+    return false;
+  }
+
+  fill_percent = std::clamp(fill_percent, 1, 100);
+  int leaf_fill = std::clamp(leaf_max_size_ * fill_percent / 100, (leaf_max_size_ + 1) / 2, leaf_max_size_);
+  int internal_min = std::max(2, (internal_max_size_ + 1) / 2);
+  int internal_fill = std::clamp(internal_max_size_ * fill_percent / 100, internal_min, internal_max_size_);
+
+  // the first key and the page id of every page of the level built last
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  BasicPageGuard leaf_guard;
+  LeafPage *leaf = nullptr;
+  // the previous leaf stays pinned, so that the last leaf can take some of its pairs
+  BasicPageGuard prev_guard;
+  LeafPage *prev = nullptr;
+  // the pages of the tree so far, which are deleted again if the buffer pool runs out of frames
+  std::vector<page_id_t> new_page_ids;
+  auto new_page = [&](page_id_t *page_id) -> BasicPageGuard {
+    Page *page = bpm_->NewPage(page_id, &extent_);
+    if (page == nullptr) {
+      prev_guard.Drop();
+      leaf_guard.Drop();
+      for (auto new_page_id : new_page_ids) {
+        bpm_->DeletePage(new_page_id);
+      }
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to bulk load the tree");
+    }
+    new_page_ids.push_back(*page_id);
+    return {bpm_, page};
+  };
+  MappingType pair;
+  while (next(&pair)) {
+    if (leaf != nullptr) {
+      int cmp = comparator_(pair.first, leaf->KeyAt(leaf->GetSize() - 1));
+      BUSTUB_ASSERT(cmp >= 0, "bulk loaded keys must be in ascending order");
+      if (cmp == 0) {
+        continue;
+      }
+    }
+    if (leaf == nullptr || leaf->GetSize() == leaf_fill) {
+      page_id_t page_id;
+      BasicPageGuard guard = new_page(&page_id);
+      auto new_leaf = guard.AsMut<LeafPage>();
+      new_leaf->Init(leaf_max_size_);
+      if (leaf != nullptr) {
+        leaf->SetNextPageId(page_id);
+      }
+      prev_guard = std::move(leaf_guard);
+      prev = leaf;
+      leaf_guard = std::move(guard);
+      leaf = new_leaf;
+      level.emplace_back(pair.first, page_id);
+    }
+    leaf->SequentialInsert(leaf->GetSize(), std::move(pair));
+  }
+  if (leaf == nullptr) {
+    return true;
+  }
+
+  // a last leaf that is less than half full shares the pairs of the previous one, or gives them all to it if both
+  // could not be half full
+  if (prev != nullptr && leaf->GetSize() < leaf->GetMinSize()) {
+    int total = prev->GetSize() + leaf->GetSize();
+    if (total < 2 * leaf->GetMinSize()) {
+      for (int i = 0; i < leaf->GetSize(); i++) {
+        prev->SetMapAt(prev->GetSize() + i, leaf->KeyAt(i), leaf->ValueAt(i));
+      }
+      prev->SetSize(total);
+      prev->SetNextPageId(INVALID_PAGE_ID);
+      page_id_t page_id = level.back().second;
+      level.pop_back();
+      leaf_guard.Drop();
+      bpm_->DeletePage(page_id);
+      new_page_ids.pop_back();
+      leaf = nullptr;
+    }
+  }
+  if (leaf != nullptr && prev != nullptr && leaf->GetSize() < leaf->GetMinSize()) {
+    int total = prev->GetSize() + leaf->GetSize();
+    int moved = total / 2 - leaf->GetSize();
+    for (int i = leaf->GetSize() - 1; i >= 0; i--) {
+      leaf->SetMapAt(i + moved, leaf->KeyAt(i), leaf->ValueAt(i));
+    }
+    for (int i = 0; i < moved; i++) {
+      int from = prev->GetSize() - moved + i;
+      leaf->SetMapAt(i, prev->KeyAt(from), prev->ValueAt(from));
+    }
+    leaf->SetSize(total / 2);
+    prev->SetSize(total - total / 2);
+    level.back().first = leaf->KeyAt(0);
+  }
+  prev_guard.Drop();
+  leaf_guard.Drop();
+
+  while (level.size() > 1) {
+    // full pages, and what is left shared between the last two pages if it would be less than half full on its own,
+    // or added to the page before if both could not be half full
+    std::vector<size_t> sizes(level.size() / internal_fill, internal_fill);
+    if (level.size() % internal_fill != 0) {
+      sizes.push_back(level.size() % internal_fill);
+    }
+    if (sizes.size() >= 2 && sizes.back() < static_cast<size_t>(internal_min)) {
+      size_t total = sizes[sizes.size() - 2] + sizes.back();
+      if (total < 2 * static_cast<size_t>(internal_min) &&
+          total <= static_cast<size_t>(internal_max_size_)) {
+        sizes.pop_back();
+        sizes.back() = total;
+      } else {
+        sizes.back() = total / 2;
+        sizes[sizes.size() - 2] = total - total / 2;
+      }
+    }
+
+    std::vector<std::pair<KeyType, page_id_t>> upper;
+    size_t pos = 0;
+    for (auto size : sizes) {
+      page_id_t page_id;
+      BasicPageGuard guard = new_page(&page_id);
+      auto internal_page = guard.AsMut<InternalPage>();
+      internal_page->Init(internal_max_size_);
+      internal_page->SetValueAt(0, level[pos].second);
+      for (size_t i = 1; i < size; i++) {
+        internal_page->SequentialInsert(static_cast<int>(i), std::pair<KeyType, page_id_t>(level[pos + i]));
+      }
+      upper.emplace_back(level[pos].first, page_id);
+      pos += size;
+    }
+    level = std::move(upper);
+  }
+
+  header_page->root_page_id_ = level.front().second;
+  return true;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -646,6 +933,10 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   // Declaration of context instance.
   Context ctx;
 
+  if (optimistic_writes_ && RemoveFromLeafOptimistic(key)) {
+    return;
+  }
+
   // If current tree is empty, return immediately.
   if (IsEmpty()) {
     return;
@@ -702,10 +993,14 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     if (ctx.header_page_ && ctx.IsRootPage(leaf_page_guard.PageId()) && leaf_page->GetSize() == 0) {
       auto header_page = ctx.header_page_->AsMut<BPlusTreeHeaderPage>();
       header_page->root_page_id_ = INVALID_PAGE_ID;
+      ctx.deleted_page_set_.push_back(leaf_page_guard.PageId());
     }
 
     leaf_page_guard.Drop();
     ctx.header_page_ = std::nullopt;
+    for (auto page_id : ctx.deleted_page_set_) {
+      bpm_->DeletePage(page_id);
+    }
     return;
   }
 
@@ -745,7 +1040,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     return;
   }
 
-  MergeLeaf(leaf_page, father_internal_page, father_page_index);
+  ctx.deleted_page_set_.push_back(MergeLeaf(leaf_page, father_internal_page, father_page_index));
 
   leaf_page_guard.Drop();
 
@@ -770,6 +1065,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     if (ctx.header_page_) {
       header_page = ctx.header_page_->AsMut<BPlusTreeHeaderPage>();
       header_page->root_page_id_ = father_internal_page->ValueAt(0);
+      ctx.deleted_page_set_.push_back(father_guard.PageId());
     }
   }
 
@@ -777,13 +1073,21 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   if (ctx.header_page_) {
     ctx.header_page_->Drop();
   }
+
+  // a page that is still pinned, e.g. by an iterator, fails to be deleted and is only leaked
+  for (auto page_id : ctx.deleted_page_set_) {
+    bpm_->DeletePage(page_id);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::MergeLeaf(LeafPage *leaf_page, InternalPage *father_internal_page, int father_page_index) -> bool {
+auto BPLUSTREE_TYPE::MergeLeaf(LeafPage *leaf_page, InternalPage *father_internal_page, int father_page_index)
+    -> page_id_t {
   page_id_t leaf_page_id = INVALID_PAGE_ID;
+  page_id_t merged_page_id = INVALID_PAGE_ID;
   WritePageGuard sibling_guard;
   if (father_page_index >= 1) {  // can merge the node into its left sibling node
+    merged_page_id = father_internal_page->ValueAt(father_page_index);
     leaf_page_id = father_internal_page->ValueAt(father_page_index - 1);
     sibling_guard = bpm_->FetchPageWrite(leaf_page_id);
     auto left_sibling = sibling_guard.template AsMut<LeafPage>();
@@ -802,6 +1106,7 @@ auto BPLUSTREE_TYPE::MergeLeaf(LeafPage *leaf_page, InternalPage *father_interna
     }
   } else {  // can merge the node into its left sibling node
     leaf_page_id = father_internal_page->ValueAt(father_page_index + 1);
+    merged_page_id = leaf_page_id;
     sibling_guard = bpm_->FetchPageWrite(leaf_page_id);
     auto right_sibling = sibling_guard.template AsMut<LeafPage>();
 
@@ -822,12 +1127,12 @@ auto BPLUSTREE_TYPE::MergeLeaf(LeafPage *leaf_page, InternalPage *father_interna
 
   sibling_guard.Drop();
 
-  return true;
+  return merged_page_id;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::MergeInternal(InternalPage *internal_page, InternalPage *father_internal_page,
-                                   int father_page_index) -> int {
+                                   int father_page_index, page_id_t *merged_page_id) -> int {
   // be merged right into left
   std::pair<KeyType, page_id_t> map;
   int ret = -1;
@@ -849,6 +1154,7 @@ auto BPLUSTREE_TYPE::MergeInternal(InternalPage *internal_page, InternalPage *fa
       internal_page->SequentialInsert(internal_page->GetSize(), right_sibling->RemoveMapAt(i));
     }
 
+    *merged_page_id = guard.PageId();
     guard.Drop();
     ret = father_page_index;
   } else if (father_internal_page->GetSize() - 1 == father_page_index) {  // be merged left into it
@@ -879,9 +1185,9 @@ auto BPLUSTREE_TYPE::MergeInternal(InternalPage *internal_page, InternalPage *fa
 
     internal_page->SetSize(internal_size + left_size);
 
-    // page_id_t to_delete_page_id = guard.PageId();
     father_internal_page->SetValueAt(father_page_index - 1, father_internal_page->ValueAt(father_page_index));
 
+    *merged_page_id = guard.PageId();
     guard.Drop();
 
     ret = father_page_index - 1;
@@ -915,7 +1221,11 @@ void BPLUSTREE_TYPE::Check(InternalPage *internal_page, Context *ctx) {
       return;
     }
 
-    father_index = MergeInternal(internal_page, father_internal_page, father_index);
+    page_id_t merged_page_id = INVALID_PAGE_ID;
+    father_index = MergeInternal(internal_page, father_internal_page, father_index, &merged_page_id);
+    if (merged_page_id != INVALID_PAGE_ID) {
+      ctx->deleted_page_set_.push_back(merged_page_id);
+    }
     // if merge internal page, the key value pair in the father page is not removed temporarily, to set return value
 
     ctx->write_set_.emplace_back(std::move(guard));
@@ -1041,16 +1351,30 @@ auto BPLUSTREE_TYPE::IsStoleFromLeftInter(InternalPage *internal_page, int fathe
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  page_id_t root_page_id = bpm_->FetchPageRead(header_page_id_).As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (optimistic_reads_) {
+    ReadPageGuard leaf_guard;
+    if (!FindLeafOptimistic(nullptr, &leaf_guard)) {
+      return End();
+    }
+    page_id_t leaf_page_id = leaf_guard.PageId();
+    auto leaf_pin = leaf_guard.Downgrade();
+    return INDEXITERATOR_TYPE(bpm_, leaf_page_id, 0, true);
+  }
+
+  auto guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t root_page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
 
   if (root_page_id == INVALID_PAGE_ID) {
     return End();
   }
 
-  auto guard = bpm_->FetchPageRead(root_page_id);
+  // every parent stays latched until its child is, or the child could be merged away and its page reused
+  guard = bpm_->FetchPageRead(root_page_id);
   auto b_plus_tree_page = guard.As<BPlusTreePage>();
 
   if (b_plus_tree_page->IsLeafPage()) {
+    // the leaf stays pinned, so that it cannot be deleted, but not latched, while the iterator fetches it
+    auto leaf_pin = guard.Downgrade();
     return INDEXITERATOR_TYPE(bpm_, root_page_id, 0);
   }
 
@@ -1062,6 +1386,7 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
     b_plus_tree_page = guard.As<BPlusTreePage>();
   } while (!b_plus_tree_page->IsLeafPage());
 
+  auto leaf_pin = guard.Downgrade();
   return INDEXITERATOR_TYPE(bpm_, subtree_page_id, 0);
 }
 
@@ -1072,7 +1397,22 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  page_id_t page_id = bpm_->FetchPageRead(header_page_id_).As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (optimistic_reads_) {
+    ReadPageGuard leaf_guard;
+    if (!FindLeafOptimistic(&key, &leaf_guard)) {
+      return End();
+    }
+    auto leaf_page = leaf_guard.template As<LeafPage>();
+    int index = BinarySearch(leaf_page, key);
+    BUSTUB_ASSERT(index >= 0, "index less than 0");
+    BUSTUB_ASSERT(comparator_(leaf_page->KeyAt(index), key) == 0, "key is not exist");
+    page_id_t leaf_page_id = leaf_guard.PageId();
+    auto leaf_pin = leaf_guard.Downgrade();
+    return INDEXITERATOR_TYPE(bpm_, leaf_page_id, index, true);
+  }
+
+  auto guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
 
   if (page_id == INVALID_PAGE_ID) {
     return End();
@@ -1083,7 +1423,8 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   const InternalPage *b_plus_tree_internal_page;
 
   while (true) {
-    auto guard = bpm_->FetchPageRead(page_id);
+    // every parent stays latched until its child is, or the child could be merged away and its page reused
+    guard = bpm_->FetchPageRead(page_id);
     b_plus_tree_page = guard.As<BPlusTreePage>();
 
     if (!b_plus_tree_page->IsLeafPage()) {
@@ -1100,9 +1441,118 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   BUSTUB_ASSERT(index >= 0, "index less than 0");
   BUSTUB_ASSERT(comparator_(leaf_page->KeyAt(index), key) == 0, "key is not exist");
 
+  auto leaf_pin = guard.Downgrade();
   return INDEXITERATOR_TYPE(bpm_, page_id, index);
 }
 
+/*
+ * The keys of the tree are unique, so the keys less than a bound are those not greater than it, less the bound itself
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SeekFirst(const IndexKeyBound<KeyType> *lower, BasicPageGuard *leaf_pin) const -> int {
+  auto guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return -1;
+  }
+
+  guard = bpm_->FetchPageRead(page_id);
+  auto b_plus_tree_page = guard.As<BPlusTreePage>();
+  while (!b_plus_tree_page->IsLeafPage()) {
+    // the first key within the bound is in the child whose keys start at the last separator not greater than it, or
+    // else at the front of the next leaf
+    auto internal_page = reinterpret_cast<const InternalPage *>(b_plus_tree_page);
+    page_id = internal_page->ValueAt(lower == nullptr ? 0 : BinarySearch(internal_page, lower->key_));
+    guard = bpm_->FetchPageRead(page_id);
+    b_plus_tree_page = guard.As<BPlusTreePage>();
+  }
+
+  int index = 0;
+  if (lower != nullptr) {
+    auto leaf_page = reinterpret_cast<const LeafPage *>(b_plus_tree_page);
+    index = BinarySearch(leaf_page, lower->key_) + 1;
+    if (lower->inclusive_ && index > 0 && comparator_(leaf_page->KeyAt(index - 1), lower->key_) == 0) {
+      index--;
+    }
+  }
+  *leaf_pin = guard.Downgrade();
+  return index;
+}
+
+/*
+ * The path to the leaf stays latched: if no key of the leaf is within the bound, e.g. since the separator that led to
+ * it was removed from the leaves, the last key of the leaf before is the one, which is found by going back up to the
+ * nearest parent with a child left of the path and then down the rightmost children of that child.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SeekLast(const IndexKeyBound<KeyType> *upper, BasicPageGuard *leaf_pin) const -> int {
+  auto header_guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return -1;
+  }
+
+  std::vector<ReadPageGuard> path;
+  std::vector<int> child_indexes;
+  path.push_back(bpm_->FetchPageRead(page_id));
+  header_guard.Drop();
+  while (!path.back().As<BPlusTreePage>()->IsLeafPage()) {
+    auto internal_page = path.back().As<InternalPage>();
+    int index = internal_page->GetSize() - 1;
+    if (upper != nullptr) {
+      index = BinarySearch(internal_page, upper->key_);
+      if (!upper->inclusive_ && index > 0 && comparator_(internal_page->KeyAt(index), upper->key_) == 0) {
+        index--;
+      }
+    }
+    child_indexes.push_back(index);
+    path.push_back(bpm_->FetchPageRead(internal_page->ValueAt(index)));
+  }
+
+  auto leaf_page = path.back().As<LeafPage>();
+  int index = leaf_page->GetSize() - 1;
+  if (upper != nullptr) {
+    index = BinarySearch(leaf_page, upper->key_);
+    if (!upper->inclusive_ && index >= 0 && comparator_(leaf_page->KeyAt(index), upper->key_) == 0) {
+      index--;
+    }
+  }
+
+  if (index < 0) {
+    size_t depth = child_indexes.size();
+    while (depth > 0 && child_indexes[depth - 1] == 0) {
+      depth--;
+    }
+    if (depth == 0) {
+      return -1;
+    }
+    path.resize(depth);
+    auto internal_page = path.back().As<InternalPage>();
+    path.push_back(bpm_->FetchPageRead(internal_page->ValueAt(child_indexes[depth - 1] - 1)));
+    while (!path.back().As<BPlusTreePage>()->IsLeafPage()) {
+      internal_page = path.back().As<InternalPage>();
+      path.push_back(bpm_->FetchPageRead(internal_page->ValueAt(internal_page->GetSize() - 1)));
+    }
+    index = path.back().As<LeafPage>()->GetSize() - 1;
+  }
+
+  *leaf_pin = path.back().Downgrade();
+  return index;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Range(const std::optional<IndexKeyBound<KeyType>> &lower,
+                           const std::optional<IndexKeyBound<KeyType>> &upper, bool reverse) const
+    -> INDEXITERATOR_TYPE {
+  BasicPageGuard leaf_pin;
+  int index = reverse ? SeekLast(upper.has_value() ? &*upper : nullptr, &leaf_pin)
+                      : SeekFirst(lower.has_value() ? &*lower : nullptr, &leaf_pin);
+  if (index < 0) {
+    return INDEXITERATOR_TYPE();
+  }
+  return INDEXITERATOR_TYPE(this, bpm_, leaf_pin.PageId(), index, reverse, reverse ? lower : upper);
+}
+
 /*
  * Input parameter is void, construct an index iterator representing the end
  * of the key/value pair in the leaf node
@@ -1369,13 +1819,18 @@ auto BPLUSTREE_TYPE::ToPrintableBPlusTree(page_id_t root_id) -> PrintableBPlusTr
 }
 
 template class BPlusTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTree<GenericKey<4>, RID, IntegerComparator<4>>;
 
 template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTree<GenericKey<8>, RID, IntegerComparator<8>>;
 
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTree<GenericKey<16>, RID, IntegerComparator<16>>;
 
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTree<GenericKey<32>, RID, IntegerComparator<32>>;
 
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<GenericKey<64>, RID, IntegerComparator<64>>;
 
 }  // namespace bustub
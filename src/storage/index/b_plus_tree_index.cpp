@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/external_sort.h"
 
 namespace bustub {
 /*
@@ -17,7 +18,7 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
-    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
+    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()), bpm_(buffer_pool_manager) {
   page_id_t header_page_id;
   buffer_pool_manager->NewPage(&header_page_id);
   container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(GetMetadata()->GetName(), header_page_id,
@@ -51,6 +52,24 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &next, int fill_percent) -> bool {
+  if (!container_->IsEmpty()) {
+    return false;
+  }
+  ExternalSorter<KeyType, ValueType, KeyComparator> sorter(bpm_, comparator_);
+  Tuple key;
+  RID rid;
+  KeyType index_key;
+  while (next(&key, &rid)) {
+    index_key.SetFromKey(key);
+    sorter.Add(index_key, rid);
+  }
+  sorter.Finish();
+
+  return container_->BulkLoad([&sorter](MappingType *pair) { return sorter.Next(pair); }, fill_percent);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
@@ -60,10 +79,22 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_->End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRangeIterator(const std::optional<IndexKeyBound<KeyType>> &lower,
+                                            const std::optional<IndexKeyBound<KeyType>> &upper, bool reverse)
+    -> INDEXITERATOR_TYPE {
+  return container_->Range(lower, upper, reverse);
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<4>, RID, IntegerComparator<4>>;
+template class BPlusTreeIndex<GenericKey<8>, RID, IntegerComparator<8>>;
+template class BPlusTreeIndex<GenericKey<16>, RID, IntegerComparator<16>>;
+template class BPlusTreeIndex<GenericKey<32>, RID, IntegerComparator<32>>;
+template class BPlusTreeIndex<GenericKey<64>, RID, IntegerComparator<64>>;
 
 }  // namespace bustub
@@ -1,8 +1,10 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -14,21 +16,99 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() : current_page_id_(-1), index_(-1), current_() {}
 
+/** Extracts the leaf following a leaf page, for read-ahead. */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, page_id_t current_page_id, int index)
-    : bpm_(bpm), current_page_id_(current_page_id), index_(index) {
+static auto NextLeafPageId(const char *page_data) -> page_id_t {
+  return reinterpret_cast<const B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_data)->GetNextPageId();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, page_id_t current_page_id, int index, bool optimistic)
+    : bpm_(bpm), current_page_id_(current_page_id), index_(index), optimistic_(optimistic) {
   if (current_page_id_ == -1 && index == -1) {
     current_ = {};
   } else {
-    auto guard = bpm_->FetchPageRead(current_page_id_);
-    current_leaf_page_ = guard.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
-    current_ = current_leaf_page_->GetMapPointorAt(index_);
+    page_id_t next_page_id = LoadLeaf(current_page_id_, index_);
+    bpm_->PrefetchChain(next_page_id, NextLeafPageId<KeyType, ValueType, KeyComparator>);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(const BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                                  page_id_t current_page_id, int index, bool reverse,
+                                  std::optional<IndexKeyBound<KeyType>> stop)
+    : bpm_(bpm), current_page_id_(current_page_id), index_(index), tree_(tree), reverse_(reverse), stop_(stop) {
+  page_id_t next_page_id = LoadLeaf(current_page_id_, index_);
+  if (!reverse_) {
+    bpm_->PrefetchChain(next_page_id, NextLeafPageId<KeyType, ValueType, KeyComparator>);
+    if (index_ >= static_cast<int>(entries_.size())) {
+      NextLeaf();
+    }
   }
+  CheckStop();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(const IndexIterator &itr)
-    : bpm_(itr.bpm_), current_page_id_(itr.current_page_id_), index_(itr.index_) {}
+    : bpm_(itr.bpm_),
+      current_page_id_(itr.current_page_id_),
+      index_(itr.index_),
+      current_(itr.current_),
+      entries_(itr.entries_),
+      next_page_id_(itr.next_page_id_),
+      optimistic_(itr.optimistic_),
+      tree_(itr.tree_),
+      reverse_(itr.reverse_),
+      stop_(itr.stop_) {
+  if (current_ != nullptr) {
+    current_ = entries_.data() + index_;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator=(const IndexIterator &other) -> INDEXITERATOR_TYPE & {
+  if (this != &other) {
+    bpm_ = other.bpm_;
+    current_page_id_ = other.current_page_id_;
+    index_ = other.index_;
+    entries_ = other.entries_;
+    current_ = other.current_ != nullptr ? entries_.data() + index_ : nullptr;
+    next_page_id_ = other.next_page_id_;
+    optimistic_ = other.optimistic_;
+    tree_ = other.tree_;
+    reverse_ = other.reverse_;
+    stop_ = other.stop_;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::LoadLeaf(page_id_t page_id, int index) -> page_id_t {
+  current_page_id_ = page_id;
+  index_ = index;
+  auto copy_leaf = [&](const B_PLUS_TREE_LEAF_PAGE_TYPE *leaf) {
+    // read without the latch, the size may be torn; it is clamped so that the copy stays inside the page, and the copy
+    // is thrown away unless the version validates
+    int size = std::clamp(leaf->GetSize(), 0, static_cast<int>(LEAF_PAGE_SIZE));
+    entries_.assign(leaf->GetMapPointorAt(0), leaf->GetMapPointorAt(0) + size);
+    next_page_id_ = leaf->GetNextPageId();
+  };
+  if (optimistic_) {
+    auto guard = bpm_->FetchPageOptimistic(page_id, AccessType::Scan);
+    while (true) {
+      copy_leaf(guard.template As<B_PLUS_TREE_LEAF_PAGE_TYPE>());
+      if (guard.Validate()) {
+        break;
+      }
+      guard.Restart();
+    }
+  } else {
+    auto guard = bpm_->FetchPageRead(page_id, AccessType::Scan);
+    copy_leaf(guard.template As<B_PLUS_TREE_LEAF_PAGE_TYPE>());
+  }
+  current_ = entries_.data() + index_;
+  return next_page_id_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
@@ -41,39 +121,93 @@ auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return *current_;
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  if (reverse_) {
+    if (index_ > 0) {
+      --index_;
+      --current_;
+    } else {
+      PrevLeaf();
+    }
+    CheckStop();
+    return *this;
+  }
+
   ++index_;
   // std::cout << " index:" << index_ << "  size:" << current_leaf_page_->GetSize();
 
-  if (index_ < current_leaf_page_->GetSize()) {
+  if (index_ < static_cast<int>(entries_.size())) {
     ++current_;
   } else {
-    page_id_t next_page_id = current_leaf_page_->GetNextPageId();
-    // std::cout << "  next_page_id:" << next_page_id << std::endl;
-    if (next_page_id != -1) {
-      current_page_id_ = next_page_id;
-      auto guard = bpm_->FetchPageRead(current_page_id_);
-      current_leaf_page_ = guard.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
-
-      index_ = 0;
-      current_ = current_leaf_page_->GetMapPointorAt(index_);
-    } else {
-      current_page_id_ = -1;
-      index_ = -1;
-      current_ = {};
-    }
+    NextLeaf();
   }
+  CheckStop();
 
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::NextLeaf() {
+  page_id_t next_page_id = next_page_id_;
+  // std::cout << "  next_page_id:" << next_page_id << std::endl;
+  if (next_page_id != -1) {
+    next_page_id = LoadLeaf(next_page_id, 0);
+    bpm_->PrefetchChain(next_page_id, NextLeafPageId<KeyType, ValueType, KeyComparator>);
+  } else {
+    SetEnd();
+  }
+}
+
+/*
+ * Leaves are only linked to the next one, so the leaf before is searched for from the root, as the one holding the
+ * largest key less than the first key of the current leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrevLeaf() {
+  IndexKeyBound<KeyType> bound{entries_[0].first, false};
+  BasicPageGuard leaf_pin;
+  int index = tree_->SeekLast(&bound, &leaf_pin);
+  if (index < 0) {
+    SetEnd();
+    return;
+  }
+  LoadLeaf(leaf_pin.PageId(), index);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CheckStop() {
+  if (!stop_.has_value() || current_ == nullptr) {
+    return;
+  }
+  int cmp = tree_->comparator_(current_->first, stop_->key_);
+  if (reverse_) {
+    cmp = -cmp;
+  }
+  if (cmp > 0 || (cmp == 0 && !stop_->inclusive_)) {
+    SetEnd();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetEnd() {
+  current_page_id_ = -1;
+  index_ = -1;
+  current_ = {};
+  entries_.clear();
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class IndexIterator<GenericKey<4>, RID, IntegerComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class IndexIterator<GenericKey<8>, RID, IntegerComparator<8>>;
 
 template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class IndexIterator<GenericKey<16>, RID, IntegerComparator<16>>;
 
 template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class IndexIterator<GenericKey<32>, RID, IntegerComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<GenericKey<64>, RID, IntegerComparator<64>>;
 
 }  // namespace bustub
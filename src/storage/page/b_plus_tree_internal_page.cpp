@@ -60,6 +60,9 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   // BUSTUB_ASSERT(index != 0, "index equal 0");
   return array_[index].second;
 }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetMapPointorAt(int index) const -> const MappingType * { return &array_[index]; }
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetMapAt(int index, const KeyType &key, const ValueType &value) {
   array_[index].first = key;
@@ -118,4 +121,9 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, IntegerComparator<4>>;
+template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, IntegerComparator<8>>;
+template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, IntegerComparator<16>>;
+template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, IntegerComparator<32>>;
+template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, IntegerComparator<64>>;
 }  // namespace bustub
@@ -117,4 +117,9 @@ template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<4>, RID, IntegerComparator<4>>;
+template class BPlusTreeLeafPage<GenericKey<8>, RID, IntegerComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID, IntegerComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<32>, RID, IntegerComparator<32>>;
+template class BPlusTreeLeafPage<GenericKey<64>, RID, IntegerComparator<64>>;
 }  // namespace bustub
@@ -48,6 +48,16 @@ BasicPageGuard::~BasicPageGuard() {  // NOLINT
   }
 }
 
+auto BasicPageGuard::UpgradeRead() -> ReadPageGuard {
+  ReadPageGuard read_guard;
+  if (page_ != nullptr && bpm_ != nullptr) {
+    page_->RLatch();
+    // The pin now belongs to the read guard.
+    read_guard.guard_ = std::move(*this);
+  }
+  return read_guard;
+}
+
 ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept : guard_(std::move(that.guard_)) {}
 
 auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard & {
@@ -75,6 +85,44 @@ ReadPageGuard::~ReadPageGuard() {  // NOLINT
   }
 }
 
+auto ReadPageGuard::Downgrade() -> BasicPageGuard {
+  if (guard_.page_ != nullptr && guard_.bpm_ != nullptr) {
+    guard_.page_->RUnlatch();
+  }
+  return std::move(guard_);
+}
+
+auto OptimisticReadGuard::UpgradeRead(ReadPageGuard *read_guard) -> bool {
+  Page *page = guard_.page_;
+  page->RLatch();
+  if (!page->ValidateVersion(version_)) {
+    page->RUnlatch();
+    guard_.Drop();
+    return false;
+  }
+  *read_guard = ReadPageGuard(guard_.bpm_, page);
+  // The pin now belongs to the read guard.
+  guard_.page_ = nullptr;
+  guard_.bpm_ = nullptr;
+  return true;
+}
+
+auto OptimisticReadGuard::UpgradeWrite(WritePageGuard *write_guard) -> bool {
+  Page *page = guard_.page_;
+  page->WLatch();
+  // taking the latch made the version odd, one past the version read without it if nobody came in between
+  if (!page->ValidateVersion(version_ + 1)) {
+    page->WUnlatch();
+    guard_.Drop();
+    return false;
+  }
+  *write_guard = WritePageGuard(guard_.bpm_, page);
+  // The pin now belongs to the write guard.
+  guard_.page_ = nullptr;
+  guard_.bpm_ = nullptr;
+  return true;
+}
+
 WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept : guard_(std::move(that.guard_)) {}
 
 auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard & {
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer replacer(4);
+
+  // Scenario: four pages are read, pages 0 and 1 twice. T1 holds pages 2 and 3, T2 holds pages 0 and 1.
+  for (frame_id_t fid = 0; fid < 4; fid++) {
+    replacer.RecordAccess(fid, AccessType::Get, fid);
+    replacer.SetEvictable(fid, true);
+  }
+  replacer.RecordAccess(0, AccessType::Get, 0);
+  replacer.RecordAccess(1, AccessType::Get, 1);
+  // a scan does not move page 3 into T2
+  replacer.RecordAccess(3, AccessType::Scan, 3);
+  ASSERT_EQ(4, replacer.Size());
+
+  // Scenario: T1 is above its target size of 0, so its pages go first and are remembered in B1.
+  frame_id_t value;
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+
+  // Scenario: page 2 comes back from B1, so T1 was too small. Page 5 is new.
+  replacer.RecordAccess(2, AccessType::Get, 2);
+  replacer.SetEvictable(2, true);
+  ASSERT_EQ(1, replacer.GetTarget());
+  replacer.RecordAccess(3, AccessType::Get, 5);
+  replacer.SetEvictable(3, true);
+
+  // Scenario: T1 is within its target now, the least recently used page of T2 goes to B2.
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 0 comes back from B2, so T2 was too small, and T1 gives up its page.
+  replacer.RecordAccess(0, AccessType::Get, 0);
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(0, replacer.GetTarget());
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+
+  // Scenario: pinned frames are skipped, and removed frames are not remembered.
+  replacer.SetEvictable(1, false);
+  replacer.Remove(2);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_FALSE(replacer.Evict(&value));
+  ASSERT_EQ(0, replacer.Size());
+}
+
+}  // namespace bustub
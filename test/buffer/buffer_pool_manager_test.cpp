@@ -12,11 +12,18 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <mutex>  // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -169,4 +176,855 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ParallelInstancesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 5;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_instances);
+  EXPECT_EQ(num_instances, bpm->GetNumInstances());
+
+  // Scenario: New pages are spread over the instances, each of them allocating from an extent of its own.
+  auto instance_of = [&](page_id_t page_id) { return page_id / BUFFER_POOL_EXTENT_SIZE % num_instances; };
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<page_id_t>(i % num_instances * BUFFER_POOL_EXTENT_SIZE + i / num_instances), page_id_temp);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+
+  // Scenario: Once every instance is full, we should not be able to create any new pages.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Only the instance owning page_ids[3] has an evictable frame, so the next page must be owned by it too.
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[3], true));
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(instance_of(page_ids[3]), instance_of(page_id_temp));
+  EXPECT_EQ(page_ids[3] + 2, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: Pages written back by one instance can be fetched again with their content intact.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    if (i != 3) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], true));
+    }
+  }
+  for (auto page_id : page_ids) {
+    page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerTest, IoOutsideLatchTest) {
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: page 0 lives on disk only, pages 1 (dirty) and 2 are resident.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 3; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(true, bpm->FlushPage(2));
+
+  // Scenario: two threads miss on page 0. The victim (page 1) is written back and page 0 read while other threads
+  // keep using page 2. Both threads end up with the same frame.
+  const size_t latency_ms = 200;
+  disk_manager->SetLatency(latency_ms);
+  std::vector<Page *> fetched(2, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < fetched.size(); ++i) {
+    threads.emplace_back([&bpm, &fetched, i] { fetched[i] = bpm->FetchPage(0); });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms / 4));
+  auto start = std::chrono::steady_clock::now();
+  auto *page = bpm->FetchPage(2);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "Page 2"));
+  EXPECT_LT(elapsed, std::chrono::milliseconds(latency_ms));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_NE(nullptr, fetched[0]);
+  EXPECT_EQ(fetched[0], fetched[1]);
+  EXPECT_EQ(2, fetched[0]->GetPinCount());
+  EXPECT_EQ(0, strcmp(fetched[0]->GetData(), "Page 0"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: the written back victim comes back with its content.
+  disk_manager->SetLatency(0);
+  page = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "Page 1"));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+}
+
+TEST(BufferPoolManagerTest, PrefetchChainTest) {
+  const size_t buffer_pool_size = 16;
+  const page_id_t chain_length = 8;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  bpm->SetPrefetchDepth(4);
+
+  // Scenario: a chain of pages that only lives on disk, every page starts with the id of the next one.
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < chain_length; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    auto next_page_id = i + 1 < chain_length ? i + 1 : INVALID_PAGE_ID;
+    memcpy(page->GetData(), &next_page_id, sizeof(page_id_t));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  bpm->SetPrefetchDepth(4);
+
+  auto next_page = [](const char *page_data) -> page_id_t {
+    page_id_t next_page_id;
+    memcpy(&next_page_id, page_data, sizeof(page_id_t));
+    return next_page_id;
+  };
+  auto wait_for_issued = [&bpm](uint64_t issued) {
+    while (bpm->GetStats().prefetch_issued_ < issued) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+
+  // Scenario: the first four pages of the chain are read ahead, and fetching them counts as prefetch hits.
+  bpm->PrefetchChain(0, next_page);
+  wait_for_issued(4);
+  for (page_id_t i = 0; i < 4; ++i) {
+    auto *page = bpm->FetchPage(i, AccessType::Scan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i + 1, next_page(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(4, bpm->GetStats().prefetch_issued_);
+  EXPECT_EQ(4, bpm->GetStats().prefetch_hits_);
+
+  // Scenario: the chain is continued past resident pages, and a read-ahead page dropped unused is wasted.
+  bpm->SetPrefetchDepth(6);
+  bpm->PrefetchChain(0, next_page);
+  wait_for_issued(6);
+  auto *page = bpm->FetchPage(5, AccessType::Scan);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+  EXPECT_EQ(true, bpm->DeletePage(4));
+  EXPECT_EQ(6, bpm->GetStats().prefetch_issued_);
+  EXPECT_EQ(5, bpm->GetStats().prefetch_hits_);
+  EXPECT_EQ(1, bpm->GetStats().prefetch_wasted_);
+
+  // Scenario: the buffer pool goes away while a chain is still being read ahead from a slow disk.
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  disk_manager->SetLatency(5);
+  bpm->PrefetchChain(0, next_page);
+  bpm.reset();
+}
+
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const size_t buffer_pool_size = 10;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, log_manager.get());
+  auto wait_for_writes = [&bpm](uint64_t writes) {
+    for (int i = 0; i < 1000 && bpm->GetStats().cleaner_writes_ < writes; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+
+  // Scenario: every frame holds a dirty, unpinned page. The log records of page 0 are not durable yet.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData() + 64, BUSTUB_PAGE_SIZE - 64, "Page %zu", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FetchPage(0)->SetLSN(5);
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  enable_logging = true;
+  log_manager->SetPersistentLSN(3);
+
+  // Scenario: the cleaner writes back every page it may write, and page 0 once the log has caught up.
+  PageCleanerOptions options;
+  options.clean_target_percent_ = 100;
+  options.interval_ = std::chrono::milliseconds(1);
+  bpm->StartPageCleaner(options);
+  wait_for_writes(buffer_pool_size - 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(buffer_pool_size - 1, bpm->GetStats().cleaner_writes_);
+  log_manager->SetPersistentLSN(5);
+  wait_for_writes(buffer_pool_size);
+  bpm->StopPageCleaner();
+  enable_logging = false;
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().cleaner_writes_);
+
+  // Scenario: new pages take the frames over without writing anything back, and the old pages read back fine.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetStats().dirty_evictions_);
+  auto *page = bpm->FetchPage(3);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData() + 64, "Page 3"));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+}
+
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const size_t buffer_pool_size = 8;
+  const page_id_t num_pages = 32;
+
+  for (auto policy : {ReplacerPolicy::LRUK, ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::TwoQueue,
+                      ReplacerPolicy::ARC}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 1, policy);
+    ASSERT_EQ(policy, bpm->GetReplacerPolicy());
+
+    // Scenario: more pages than frames go through the buffer pool, and every one of them comes back intact.
+    page_id_t page_id_temp;
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", i);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    // Scenario: switching the policy keeps the resident pages, pinned ones included.
+    auto *pinned = bpm->FetchPage(num_pages - 1);
+    ASSERT_NE(nullptr, pinned);
+    bpm->SetReplacerPolicy(policy == ReplacerPolicy::ARC ? ReplacerPolicy::LRUK : ReplacerPolicy::ARC);
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+    EXPECT_EQ(pinned, bpm->FetchPage(num_pages - 1));
+    EXPECT_EQ(true, bpm->UnpinPage(num_pages - 1, false));
+    EXPECT_EQ(true, bpm->UnpinPage(num_pages - 1, false));
+  }
+}
+
+TEST(BufferPoolManagerTest, DeallocatePageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  remove("test.db");
+  remove("test.fpm");
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < 6; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a pinned page cannot be deallocated.
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(false, bpm->DeletePage(1));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+
+  // Scenario: deallocated pages are reused, the lowest first, before the file is extended.
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: pages that are not in the buffer pool anymore can be deallocated too.
+  auto end_page_id = static_cast<page_id_t>(6 + buffer_pool_size - 1);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(i == 0 ? 3 : static_cast<page_id_t>(5 + i), page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: an invalid page id, or a page of the extent that was not handed out yet, is not deallocated, so that the
+  // page is not handed out twice.
+  EXPECT_EQ(true, bpm->DeletePage(INVALID_PAGE_ID));
+  EXPECT_EQ(true, bpm->DeletePage(end_page_id + 1));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(end_page_id, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+
+  EXPECT_EQ(true, bpm->DeletePage(4));
+  bpm->FlushAllPages();
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: after a restart, the deallocated pages are reused and then the file is extended.
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  std::vector<page_id_t> expected_page_ids = {4, end_page_id + 1};
+  for (auto expected_page_id : expected_page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(expected_page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  auto *page5 = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page5);
+  EXPECT_EQ(0, strcmp(page5->GetData(), "Page 5"));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageExtentTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  remove("test.db");
+  remove("test.fpm");
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+
+  // Scenario: two owners growing at the same time get a contiguous run of pages each, apart from other pages.
+  PageExtent extents[2];
+  std::vector<page_id_t> page_ids[2];
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  for (int i = 0; i < BUFFER_POOL_EXTENT_SIZE + 1; ++i) {
+    for (int owner = 0; owner < 2; ++owner) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp, &extents[owner]));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+      page_ids[owner].push_back(page_id_temp);
+    }
+  }
+  for (int owner = 0; owner < 2; ++owner) {
+    EXPECT_EQ((owner + 1) * BUFFER_POOL_EXTENT_SIZE, page_ids[owner][0]);
+    for (int i = 1; i < BUFFER_POOL_EXTENT_SIZE; ++i) {
+      EXPECT_EQ(page_ids[owner][i - 1] + 1, page_ids[owner][i]);
+    }
+    // a used up extent is followed by a new one
+    EXPECT_EQ((owner + 3) * BUFFER_POOL_EXTENT_SIZE, page_ids[owner].back());
+  }
+
+  // Scenario: pages without an owner continue the extent of the instance.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+
+  // Scenario: an owner keeps filling its extent before it reuses deallocated pages.
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[0][5]));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp, &extents[0]));
+  EXPECT_EQ(page_ids[0].back() + 1, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: after a restart, the pages that the extents left unused before the end of the file are handed out
+  // first, the lowest first, as are deallocated pages, and then the rest of the last extent of the file.
+  bpm->FlushAllPages();
+  delete bpm;
+  delete disk_manager;
+  const page_id_t num_pages = 4 * BUFFER_POOL_EXTENT_SIZE + 1;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(num_pages, disk_manager->GetNumPages());
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  std::vector<page_id_t> expected_page_ids;
+  for (page_id_t page_id = 2; page_id < BUFFER_POOL_EXTENT_SIZE; ++page_id) {
+    expected_page_ids.push_back(page_id);
+  }
+  expected_page_ids.push_back(page_ids[0][5]);
+  for (page_id_t page_id = page_ids[0].back() + 2; page_id < 3 * BUFFER_POOL_EXTENT_SIZE + BUFFER_POOL_EXTENT_SIZE;
+       ++page_id) {
+    expected_page_ids.push_back(page_id);
+  }
+  PageExtent restarted_extent;
+  for (auto expected_page_id : expected_page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp, &restarted_extent));
+    EXPECT_EQ(expected_page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(num_pages, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: filling all of those pages and restarting again does not grow the file.
+  bpm->FlushAllPages();
+  delete bpm;
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(num_pages, disk_manager->GetNumPages());
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DirectIoTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+  remove("test.db");
+  remove("test.fpm");
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name, true);
+  if (!disk_manager->IsDirectIo()) {
+    disk_manager->ShutDown();
+    GTEST_SKIP() << "the file system does not support direct I/O";
+  }
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: frames are page aligned, and pages survive eviction without the page cache of the OS.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 3 * static_cast<int>(buffer_pool_size); ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % BUSTUB_PAGE_SIZE);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t i = 0; i < 3 * static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  bpm->FlushAllPages();
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+}
+
+/** Refuses every page write while `refuse_writes_` is set, as a disk manager that cannot write does. */
+class RefusingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    if (refuse_writes_) {
+      throw Exception("page write refused");
+    }
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+
+  std::atomic<bool> refuse_writes_{false};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FetchPagesTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<RefusingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  page_id_t page_id_temp;
+  for (int i = 0; i < 8; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a batch is deduplicated, returned in page id order, and read correctly whether resident or not.
+  {
+    auto guards = bpm->FetchPagesRead({7, 1, 5, 1, 2});
+    ASSERT_EQ(4, guards.size());
+    std::vector<page_id_t> expected = {1, 2, 5, 7};
+    for (size_t i = 0; i < guards.size(); ++i) {
+      EXPECT_EQ(expected[i], guards[i].PageId());
+      EXPECT_EQ(0, strcmp(guards[i].GetData(), ("Page " + std::to_string(expected[i])).c_str()));
+    }
+    // the resident pages 5 and 7 are not evicted for the others
+    EXPECT_EQ(2, bpm->GetStats().fetch_misses_[static_cast<size_t>(AccessType::Unknown)]);
+    EXPECT_EQ(2, bpm->GetStats().fetch_hits_[static_cast<size_t>(AccessType::Unknown)]);
+  }
+  EXPECT_TRUE(bpm->FetchPagesBasic({}).empty());
+
+  // Scenario: with a single frame left, the batch is cut short after its first page.
+  for (page_id_t i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+  }
+  {
+    auto guards = bpm->FetchPagesBasic({6, 3, 4});
+    ASSERT_EQ(1, guards.size());
+    EXPECT_EQ(3, guards[0].PageId());
+    EXPECT_EQ(0, strcmp(guards[0].GetData(), "Page 3"));
+    EXPECT_EQ(1, bpm->GetStats().pin_failures_);
+  }
+  for (page_id_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: every page can be fetched again once the batch is released.
+  for (page_id_t i = 0; i < 8; ++i) {
+    auto guard = bpm->FetchPageRead(i);
+    EXPECT_EQ(0, strcmp(guard.GetData(), ("Page " + std::to_string(i)).c_str()));
+  }
+
+  // Scenario: a dirty victim that cannot be written back keeps its frame, and the page it was evicted for is dropped
+  // from the batch, or not fetched or created at all.
+  for (page_id_t i = 0; i < 4; ++i) {
+    auto guard = bpm->FetchPageWrite(i);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "Dirty %d", i);
+  }
+  disk_manager->refuse_writes_ = true;
+  EXPECT_TRUE(bpm->FetchPagesRead({4, 5}).empty());
+  EXPECT_EQ(nullptr, bpm->FetchPage(4));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  // a page that cannot be flushed stays dirty, so that a later flush writes it
+  EXPECT_FALSE(bpm->FlushPage(0));
+  disk_manager->refuse_writes_ = false;
+  EXPECT_TRUE(bpm->FlushPage(0));
+  char data[BUSTUB_PAGE_SIZE];
+  disk_manager->ReadPage(0, data);
+  EXPECT_EQ(0, strcmp(data, "Dirty 0"));
+  size_t misses = bpm->GetStats().fetch_misses_[static_cast<size_t>(AccessType::Unknown)];
+  for (page_id_t i = 0; i < 4; ++i) {
+    auto guard = bpm->FetchPageRead(i);
+    EXPECT_EQ(0, strcmp(guard.GetData(), ("Dirty " + std::to_string(i)).c_str()));
+  }
+  EXPECT_EQ(misses, bpm->GetStats().fetch_misses_[static_cast<size_t>(AccessType::Unknown)]);
+  {
+    auto guards = bpm->FetchPagesRead({4, 5});
+    ASSERT_EQ(2, guards.size());
+    EXPECT_EQ(0, strcmp(guards[1].GetData(), "Page 5"));
+  }
+  for (page_id_t i = 0; i < 4; ++i) {
+    auto guard = bpm->FetchPageRead(i);
+    EXPECT_EQ(0, strcmp(guard.GetData(), ("Dirty " + std::to_string(i)).c_str()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, WarmRestartTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  remove("test.db");
+  remove("test.fpm");
+  remove("test.hot");
+
+  // Scenario: 16 pages are written, then the last 8 are used again so that they are the hot ones.
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  page_id_t page_id_temp;
+  for (int i = 0; i < 16; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t i = 8; i < 16; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(buffer_pool_size, bpm->SaveHotPages());
+  bpm.reset();
+  disk_manager->ShutDown();
+
+  // Scenario: after a restart, the hot pages are resident again and fetching them does not read from disk.
+  disk_manager = std::make_unique<DiskManager>(db_name);
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(buffer_pool_size, bpm->WarmUp());
+  EXPECT_EQ(0, bpm->WarmUp());
+  size_t reads = bpm->GetStats().disk_read_latency_.Count();
+  for (page_id_t i = 8; i < 16; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(reads, bpm->GetStats().disk_read_latency_.Count());
+  EXPECT_EQ(0, bpm->GetStats().fetch_misses_[static_cast<size_t>(AccessType::Unknown)]);
+  bpm.reset();
+  disk_manager->ShutDown();
+
+  // Scenario: the warm-up is bounded by a number of pages and by time.
+  disk_manager = std::make_unique<DiskManager>(db_name);
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(3, bpm->WarmUp(3));
+  bpm.reset();
+  disk_manager->ShutDown();
+  disk_manager = std::make_unique<DiskManager>(db_name);
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(0, bpm->WarmUp(SIZE_MAX, std::chrono::milliseconds(0)));
+  auto *page = bpm->FetchPage(8);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "Page 8"));
+  EXPECT_EQ(true, bpm->UnpinPage(8, false));
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+  remove("test.hot");
+}
+
+/** Records which pages are written, and how many pages every vectored write covers. */
+class RecordingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    {
+      std::scoped_lock l(latch_);
+      written_.push_back(page_id);
+    }
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) override {
+    {
+      std::scoped_lock l(latch_);
+      run_sizes_.push_back(pages.size());
+    }
+    DiskManagerUnlimitedMemory::WritePages(first_page_id, pages);
+  }
+
+  void Reset() {
+    std::scoped_lock l(latch_);
+    written_.clear();
+    run_sizes_.clear();
+  }
+
+  std::mutex latch_;
+  std::vector<page_id_t> written_;
+  std::vector<size_t> run_sizes_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<RecordingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  page_id_t page_id_temp;
+  for (int i = 0; i < 12; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: consecutive dirty pages are written together, in windows that pin a quarter of the frames at most.
+  bpm->FlushAllPages();
+  EXPECT_EQ(12, disk_manager->written_.size());
+  EXPECT_EQ((std::vector<size_t>{4, 4, 4}), disk_manager->run_sizes_);
+
+  // Scenario: only the pages modified since are written again, nothing at all if there are none.
+  disk_manager->Reset();
+  for (page_id_t page_id : {9, 3, 5, 4}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  std::sort(disk_manager->written_.begin(), disk_manager->written_.end());
+  EXPECT_EQ((std::vector<page_id_t>{3, 4, 5, 9}), disk_manager->written_);
+  EXPECT_EQ(std::vector<size_t>{3}, disk_manager->run_sizes_);
+  disk_manager->Reset();
+  bpm->FlushAllPages();
+  EXPECT_TRUE(disk_manager->written_.empty());
+
+  // Scenario: a page held by a writer, here the thread flushing itself, is neither waited for nor written while it may
+  // be changing. It stays dirty, and the next flush writes it.
+  for (page_id_t page_id : {2, 7}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  {
+    auto guard = bpm->FetchPageWrite(2);
+    bpm->FlushAllPages();
+    EXPECT_EQ(std::vector<page_id_t>{7}, disk_manager->written_);
+  }
+  disk_manager->Reset();
+  bpm->FlushAllPages();
+  EXPECT_EQ(std::vector<page_id_t>{2}, disk_manager->written_);
+  disk_manager->Reset();
+  bpm->FlushAllPages();
+  EXPECT_TRUE(disk_manager->written_.empty());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, CompressedCacheTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  bpm->SetCompressedCacheSize(64 * 1024);
+  const auto &stats = bpm->GetStats();
+
+  // Scenario: evicted pages, clean or dirty, go to the compressed cache.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 12; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, i % 2 == 0));
+  }
+  EXPECT_EQ(8, stats.compressed_stores_);
+  EXPECT_EQ(8, bpm->GetCompressedCache()->Size());
+  EXPECT_LT(stats.compressed_bytes_, 8 * BUSTUB_PAGE_SIZE / 4);
+
+  // Scenario: misses are served from the compressed cache without reading from disk, even for pages never written.
+  size_t reads = stats.disk_read_latency_.Count();
+  for (page_id_t i = 0; i < 8; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(reads, stats.disk_read_latency_.Count());
+  EXPECT_EQ(8, stats.compressed_hits_);
+  EXPECT_EQ(0, stats.compressed_misses_);
+
+  // Scenario: a batch finds its pages in the compressed cache too.
+  auto guards = bpm->FetchPagesRead({8, 9});
+  ASSERT_EQ(2, guards.size());
+  EXPECT_EQ(0, strcmp(guards[1].GetData(), "Page 9"));
+  EXPECT_EQ(10, stats.compressed_hits_);
+  guards.clear();
+
+  // Scenario: a deleted page does not come back from the compressed cache.
+  for (page_id_t i = 4; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_NE(0, strcmp(page->GetData(), "Page 0"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(1, stats.compressed_misses_);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, AdmissionFilterTest) {
+  const size_t buffer_pool_size = 10;
+
+  // Scenario: under plain LRU, a burst of one-off reads of cold pages evicts the hot pages, unless they are filtered.
+  for (bool admission_filter : {false, true}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr, 1,
+                                                   ReplacerPolicy::LRU);
+    bpm->SetAdmissionFilter(admission_filter);
+    const auto &stats = bpm->GetStats();
+    page_id_t page_id_temp;
+    for (int i = 0; i < 30; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    // the hot pages fill the frames outside of the probationary area
+    for (int round = 0; round < 3; ++round) {
+      for (page_id_t i = 0; i < 9; ++i) {
+        ASSERT_NE(nullptr, bpm->FetchPage(i));
+        EXPECT_EQ(true, bpm->UnpinPage(i, false));
+      }
+    }
+    for (page_id_t i = 9; i < 30; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+
+    // Scenario: the last cold page is still resident, fetching it again takes it out of probation.
+    ASSERT_NE(nullptr, bpm->FetchPage(29));
+    EXPECT_EQ(true, bpm->UnpinPage(29, false));
+    EXPECT_EQ(admission_filter ? 1 : 0, stats.admission_promotions_);
+
+    // the most recent hot pages are checked first, so that a miss does not evict the others under LRU
+    uint64_t hits = stats.fetch_hits_[static_cast<size_t>(AccessType::Unknown)];
+    for (page_id_t i = 8; i >= 0; --i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+    hits = stats.fetch_hits_[static_cast<size_t>(AccessType::Unknown)] - hits;
+    if (!admission_filter) {
+      EXPECT_EQ(0, hits);
+      EXPECT_EQ(0, stats.admission_rejects_);
+    } else {
+      // the probationary area of a single frame was kept free for the cold pages, so every hot page stayed
+      EXPECT_EQ(21, stats.admission_rejects_);
+      EXPECT_EQ(9, hits);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  const auto &stats = bpm->GetStats();
+
+  // Scenario: the third page evicts the dirty first one.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(1, stats.dirty_evictions_);
+
+  // Scenario: a miss reads from disk, a hit does not.
+  ASSERT_NE(nullptr, bpm->FetchPage(0, AccessType::Get));
+  ASSERT_NE(nullptr, bpm->FetchPage(0, AccessType::Get));
+  EXPECT_EQ(1, stats.fetch_hits_[static_cast<size_t>(AccessType::Get)]);
+  EXPECT_EQ(1, stats.fetch_misses_[static_cast<size_t>(AccessType::Get)]);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(2, stats.fetch_latency_.Count());
+  EXPECT_EQ(1, stats.disk_read_latency_.Count());
+  EXPECT_LE(stats.fetch_latency_.PercentileNs(0.5), stats.fetch_latency_.PercentileNs(1.0));
+
+  // Scenario: with every frame pinned, fetches and new pages fail.
+  ASSERT_NE(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(2, stats.pin_failures_);
+  EXPECT_EQ(4, stats.fetch_latency_.Count());
+
+  auto rows = stats.Describe();
+  auto row = std::find_if(rows.begin(), rows.end(), [](const auto &row) { return row.first == "pin_failures"; });
+  ASSERT_NE(rows.end(), row);
+  EXPECT_EQ("2", row->second);
+}
+
 }  // namespace bustub
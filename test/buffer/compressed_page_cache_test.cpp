@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "buffer/compressed_page_cache.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** A page laid out like a table page: a header, tuples at the end, and free space in between. */
+auto MakeTablePage(int seed) -> std::vector<char> {
+  std::vector<char> page(BUSTUB_PAGE_SIZE, 0);
+  snprintf(page.data(), 64, "header %d", seed);
+  for (int i = 0; i < 40; ++i) {
+    snprintf(page.data() + BUSTUB_PAGE_SIZE - 32 * (i + 1), 32, "tuple %d of page %d", i, seed);
+  }
+  return page;
+}
+
+}  // namespace
+
+TEST(CompressedPageCacheTest, CompressTest) {
+  std::vector<char> out(BUSTUB_PAGE_SIZE);
+  std::vector<char> back(BUSTUB_PAGE_SIZE);
+
+  // Scenario: pages with free space and repeated values come back unchanged, and much smaller.
+  std::vector<std::vector<char>> pages;
+  pages.emplace_back(BUSTUB_PAGE_SIZE, 0);
+  pages.push_back(MakeTablePage(1));
+  for (auto &page : pages) {
+    size_t size = CompressedPageCache::Compress(page.data(), out.data(), out.size());
+    ASSERT_GT(size, 0);
+    EXPECT_LT(size, BUSTUB_PAGE_SIZE / 3);
+    ASSERT_TRUE(CompressedPageCache::Decompress(out.data(), size, back.data()));
+    EXPECT_EQ(page, back);
+  }
+
+  // Scenario: random data does not fit into a page sized buffer, but still round-trips given enough room.
+  std::mt19937 rng(42);
+  std::vector<char> random(BUSTUB_PAGE_SIZE);
+  for (auto &c : random) {
+    c = static_cast<char>(rng());
+  }
+  EXPECT_EQ(0, CompressedPageCache::Compress(random.data(), out.data(), out.size()));
+  std::vector<char> large(2 * BUSTUB_PAGE_SIZE);
+  size_t size = CompressedPageCache::Compress(random.data(), large.data(), large.size());
+  ASSERT_GT(size, 0);
+  ASSERT_TRUE(CompressedPageCache::Decompress(large.data(), size, back.data()));
+  EXPECT_EQ(random, back);
+
+  // Scenario: truncated input is rejected.
+  size = CompressedPageCache::Compress(pages[1].data(), out.data(), out.size());
+  EXPECT_FALSE(CompressedPageCache::Decompress(out.data(), size - 1, back.data()));
+}
+
+TEST(CompressedPageCacheTest, CapacityTest) {
+  auto page_size = CompressedPageCache::Compress(MakeTablePage(0).data(), std::vector<char>(BUSTUB_PAGE_SIZE).data(),
+                                                 BUSTUB_PAGE_SIZE);
+  CompressedPageCache cache(4 * (page_size + CompressedPageCache::ENTRY_OVERHEAD) + 10);
+  std::vector<char> back(BUSTUB_PAGE_SIZE);
+
+  // Scenario: four table pages fit, a fifth pushes out the one put first.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_GT(cache.Put(i, MakeTablePage(i).data()), 0);
+  }
+  EXPECT_EQ(4, cache.Size());
+  EXPECT_LE(cache.UsedBytes(), 4 * (page_size + CompressedPageCache::ENTRY_OVERHEAD) + 10);
+  EXPECT_FALSE(cache.Take(0, back.data()));
+
+  // Scenario: a page is taken out of the cache, and a newer copy replaces an older one.
+  ASSERT_TRUE(cache.Take(1, back.data()));
+  EXPECT_EQ(MakeTablePage(1), back);
+  EXPECT_FALSE(cache.Take(1, back.data()));
+  EXPECT_GT(cache.Put(2, MakeTablePage(7).data()), 0);
+  ASSERT_TRUE(cache.Take(2, back.data()));
+  EXPECT_EQ(MakeTablePage(7), back);
+
+  // Scenario: an erased page is gone, and a page larger than the whole cache is not kept.
+  cache.Erase(3);
+  EXPECT_FALSE(cache.Take(3, back.data()));
+  CompressedPageCache tiny(16);
+  EXPECT_EQ(0, tiny.Put(0, MakeTablePage(0).data()));
+  EXPECT_EQ(0, tiny.Size());
+}
+
+}  // namespace bustub
@@ -163,4 +163,77 @@ TEST(LRUKReplacerTest, SampleTest2) {
   }
   ASSERT_EQ(1767, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, EvictionOrderTest) {
+  LRUKReplacer lru_replacer(8, 3);
+
+  // frames 0..3 reach k accesses, frames 4 and 5 stay below k
+  for (int round = 0; round < 3; round++) {
+    for (int fid = 0; fid < 4; fid++) {
+      lru_replacer.RecordAccess(fid);
+    }
+  }
+  lru_replacer.RecordAccess(5);
+  lru_replacer.RecordAccess(4);
+  lru_replacer.RecordAccess(4);
+  // frame 2 is touched again, its k-th most recent access moves past frame 3's
+  lru_replacer.RecordAccess(2);
+
+  for (int fid = 0; fid < 6; fid++) {
+    lru_replacer.SetEvictable(fid, true);
+  }
+  // pinned frames are never handed out
+  lru_replacer.SetEvictable(0, false);
+  ASSERT_EQ(5, lru_replacer.Size());
+
+  // +inf k-distance first, by their earliest access; then the smallest k-th most recent access
+  std::vector<frame_id_t> expected{5, 4, 1, 3, 2};
+  for (auto want : expected) {
+    frame_id_t value;
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(want, value);
+  }
+  frame_id_t value;
+  ASSERT_FALSE(lru_replacer.Evict(&value));
+  ASSERT_EQ(0, lru_replacer.Size());
+
+  // an evicted frame starts over with an empty history
+  lru_replacer.SetEvictable(0, true);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.SetEvictable(1, true);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(8, 2);
+
+  // frames 0 and 1 form the working set, frames 2..4 are only touched by a scan
+  lru_replacer.RecordAccess(0, AccessType::Get);
+  lru_replacer.RecordAccess(1, AccessType::Get);
+  lru_replacer.RecordAccess(1, AccessType::Get);
+  for (int fid = 2; fid < 5; fid++) {
+    lru_replacer.RecordAccess(fid, AccessType::Scan);
+  }
+  // a scan passing over the working set leaves its order alone
+  lru_replacer.RecordAccess(0, AccessType::Scan);
+  // a lookup takes frame 3 out of the scan ring
+  lru_replacer.RecordAccess(3, AccessType::Get);
+
+  for (int fid = 0; fid < 5; fid++) {
+    lru_replacer.SetEvictable(fid, true);
+  }
+  ASSERT_EQ(5, lru_replacer.Size());
+
+  // scanned frames go first, oldest first, then the working set in LRU-K order
+  std::vector<frame_id_t> expected{2, 4, 0, 3, 1};
+  for (auto want : expected) {
+    frame_id_t value;
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(want, value);
+  }
+  ASSERT_EQ(0, lru_replacer.Size());
+}
 }  // namespace bustub
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  TwoQueueReplacer replacer(8);
+
+  // Scenario: four pages are read once, more than A1in keeps (a quarter of the frames).
+  for (frame_id_t fid = 0; fid < 4; fid++) {
+    replacer.RecordAccess(fid, AccessType::Get, 100 + fid);
+    replacer.SetEvictable(fid, true);
+  }
+  ASSERT_EQ(4, replacer.Size());
+  frame_id_t value;
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 100 comes back while remembered in A1out and goes to Am. Page 104 is new, and a second access
+  // right after the first one does not promote it.
+  replacer.RecordAccess(0, AccessType::Get, 100);
+  replacer.SetEvictable(0, true);
+  replacer.RecordAccess(1, AccessType::Get, 104);
+  replacer.RecordAccess(1, AccessType::Get, 104);
+  replacer.SetEvictable(1, true);
+
+  // Scenario: A1in is trimmed back to its size first, then Am goes before the rest of A1in.
+  std::vector<frame_id_t> expected{2, 0, 3, 1};
+  for (auto want : expected) {
+    ASSERT_TRUE(replacer.Evict(&value));
+    ASSERT_EQ(want, value);
+  }
+  ASSERT_FALSE(replacer.Evict(&value));
+  ASSERT_EQ(0, replacer.Size());
+}
+
+}  // namespace bustub
@@ -489,4 +489,109 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest2) {
   delete bpm;
 }
 
+TEST(BPlusTreeConcurrentTest, OptimisticReadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  tree.SetOptimisticReads(true);
+
+  std::vector<int64_t> keys;
+  std::vector<int64_t> new_keys;
+  int64_t scale_factor = 50000;
+  for (int64_t key = 1; key < scale_factor; key++) {
+    (key % 2 == 0 ? keys : new_keys).push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  // look up the existing keys while inserting the others keeps splitting the pages the readers go through
+  std::thread writer([&tree, &new_keys] { InsertHelper(&tree, new_keys); });
+  LaunchParallelTest(2, LookupHelper, &tree, keys, 1);
+  writer.join();
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    ASSERT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, scale_factor);
+
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(scale_factor / 2);
+  current_key = scale_factor / 2;
+  for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+    ASSERT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, scale_factor);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticWriteTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree, with small pages so that many inserts and removes still have to split and merge
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 8, 8);
+  tree.SetOptimisticReads(true);
+  tree.SetOptimisticWrites(true);
+
+  std::vector<int64_t> keys;
+  std::vector<int64_t> even_keys;
+  std::vector<int64_t> odd_keys;
+  int64_t scale_factor = 20000;
+  for (int64_t key = 1; key < scale_factor; key++) {
+    keys.push_back(key);
+    (key % 2 == 0 ? even_keys : odd_keys).push_back(key);
+  }
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+
+  // inserting a key again fails, whether its leaf is full or not
+  GenericKey<8> index_key;
+  RID rid;
+  index_key.SetFromInteger(2);
+  EXPECT_FALSE(tree.Insert(index_key, rid));
+
+  // remove the odd keys while the even ones are looked up
+  std::thread reader([&tree, &even_keys] { LookupHelper(&tree, even_keys, 1); });
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, odd_keys, 4);
+  reader.join();
+
+  int64_t current_key = 2;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    ASSERT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 2;
+  }
+  EXPECT_EQ(current_key, scale_factor);
+
+  // removing everything goes back to an empty tree, and a missing key is a no-op
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, even_keys, 4);
+  EXPECT_TRUE(tree.IsEmpty());
+  DeleteHelper(&tree, even_keys);
+  InsertHelper(&tree, {7});
+  std::vector<RID> result;
+  index_key.SetFromInteger(7);
+  EXPECT_TRUE(tree.GetValue(index_key, &result));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -281,4 +281,56 @@ TEST(BPlusTreeTests, DeleteTest3) {
   delete transaction;
   delete bpm;
 }
+TEST(BPlusTreeTests, DeletePageReuseTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 5);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 100; key++) {
+    keys.push_back(key);
+  }
+
+  // insert and remove the same keys again and again, the pages emptied by merges are reused
+  page_id_t high_water = INVALID_PAGE_ID;
+  for (int round = 0; round < 5; round++) {
+    for (auto key : keys) {
+      rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+
+    auto probe = bpm->NewPage(&page_id);
+    ASSERT_NE(probe, nullptr);
+    if (round == 0) {
+      high_water = page_id;
+    } else {
+      EXPECT_LE(page_id, high_water);
+    }
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
 }  // namespace bustub
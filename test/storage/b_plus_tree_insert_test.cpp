@@ -12,8 +12,12 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <optional>
+#include <set>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
@@ -62,6 +66,30 @@ TEST(BPlusTreeTests, InsertTest1) {
   delete bpm;
 }
 
+TEST(BPlusTreeTests, InsertFirstKeyTest) {
+  auto key_schema = ParseCreateStatement("a int");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page_id, bpm.get(), comparator);
+  GenericKey<8> index_key;
+  for (int64_t key : {8, 3}) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(0, key)));
+  }
+
+  // Scenario: a key less than all keys of a leaf is not mistaken for the header in front of them, whose page type
+  // reads as key 1.
+  std::vector<RID> rids;
+  index_key.SetFromInteger(1);
+  EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  EXPECT_TRUE(tree.Insert(index_key, RID(0, 1)));
+  ASSERT_TRUE(tree.GetValue(index_key, &rids));
+  EXPECT_EQ(1, rids[0].GetSlotNum());
+}
+
 TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
@@ -229,6 +257,265 @@ TEST(BPlusTreeTests, InsertTest3) {
   delete bpm;
 }
 
+namespace {
+
+/** @return the number of pairs in each leaf, from left to right */
+auto LeafSizes(BufferPoolManager *bpm, page_id_t root_page_id) -> std::vector<int> {
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  page_id_t page_id = root_page_id;
+  while (true) {
+    auto guard = bpm->FetchPageRead(page_id);
+    if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+      break;
+    }
+    page_id = guard.As<InternalPage>()->ValueAt(0);
+  }
+  std::vector<int> sizes;
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = bpm->FetchPageRead(page_id);
+    sizes.push_back(guard.As<LeafPage>()->GetSize());
+    page_id = guard.As<LeafPage>()->GetNextPageId();
+  }
+  return sizes;
+}
+
+/** @return the number of pages below the root of a subtree that are less than half full */
+auto UnderfullPages(BufferPoolManager *bpm, page_id_t page_id, bool is_root = true) -> int {
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  auto guard = bpm->FetchPageRead(page_id);
+  const auto *page = guard.As<BPlusTreePage>();
+  int underfull = !is_root && page->GetSize() < page->GetMinSize() ? 1 : 0;
+  if (!page->IsLeafPage()) {
+    for (int i = 0; i < page->GetSize(); i++) {
+      underfull += UnderfullPages(bpm, guard.As<InternalPage>()->ValueAt(i), false);
+    }
+  }
+  return underfull;
+}
+
+}  // namespace
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  auto load = [](BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, std::vector<int64_t> keys,
+                 int fill_percent) {
+    size_t next = 0;
+    return tree->BulkLoad(
+        [&](std::pair<GenericKey<8>, RID> *pair) {
+          if (next == keys.size()) {
+            return false;
+          }
+          pair->first.SetFromInteger(keys[next]);
+          pair->second.Set(static_cast<int32_t>(keys[next] >> 32), static_cast<uint32_t>(keys[next]));
+          next++;
+          return true;
+        },
+        fill_percent);
+  };
+
+  // Scenario: 1000 keys build a tree of several levels that finds every key, and iterates over them in order.
+  page_id_t header_page_id;
+  bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page_id, bpm.get(), comparator, 5, 4);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; ++key) {
+    keys.push_back(2 * key);
+  }
+  ASSERT_TRUE(load(&tree, keys, 100));
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    std::vector<RID> rids;
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(1, rids.size());
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+    index_key.SetFromInteger(key + 1);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  }
+  int64_t expected = 2;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    ASSERT_EQ(expected, (*it).second.GetSlotNum());
+    expected += 2;
+  }
+  EXPECT_EQ(2002, expected);
+
+  // Scenario: at a fill factor of 100 every leaf is full.
+  auto sizes = LeafSizes(bpm.get(), tree.GetRootPageId());
+  ASSERT_EQ(200, sizes.size());
+  EXPECT_TRUE(std::all_of(sizes.begin(), sizes.end(), [](int size) { return size == 5; }));
+
+  // Scenario: a tree that is not empty cannot be bulk loaded, but takes inserts and removes as usual.
+  EXPECT_FALSE(load(&tree, {1}, 100));
+  for (int64_t key = 1; key <= 2001; key += 2) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(0, key)));
+  }
+  for (int64_t key = 2; key <= 2000; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, nullptr);
+  }
+  expected = 1;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    ASSERT_EQ(expected, (*it).second.GetSlotNum());
+    expected += 2;
+  }
+  EXPECT_EQ(2003, expected);
+
+  // Scenario: a lower fill factor leaves room in the leaves, and duplicates are dropped.
+  bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> sparse("foo_pk", header_page_id, bpm.get(), comparator, 10, 4);
+  ASSERT_TRUE(load(&sparse, {1, 2, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17}, 60));
+  sizes = LeafSizes(bpm.get(), sparse.GetRootPageId());
+  EXPECT_EQ(std::vector<int>({6, 6, 5}), sizes);
+
+  // Scenario: leaves are never made less than half full, the last one gives its pairs to the one before.
+  bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> half("foo_pk", header_page_id, bpm.get(), comparator, 10, 4);
+  ASSERT_TRUE(load(&half, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}, 10));
+  sizes = LeafSizes(bpm.get(), half.GetRootPageId());
+  EXPECT_EQ(std::vector<int>({5, 6}), sizes);
+
+  // Scenario: a last leaf and a last inner page that could not share with the page before so that both are half full
+  // are merged into it. Full leaves of 4 and inner pages of 4 children leave 1 pair and 1 leaf over.
+  bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> merged("foo_pk", header_page_id, bpm.get(), comparator, 5, 5);
+  keys.clear();
+  for (int64_t key = 1; key <= 4 * 17 + 1; ++key) {
+    keys.push_back(key);
+  }
+  ASSERT_TRUE(load(&merged, keys, 90));
+  sizes = LeafSizes(bpm.get(), merged.GetRootPageId());
+  EXPECT_EQ(17, sizes.size());
+  EXPECT_EQ(5, sizes.back());
+  EXPECT_EQ(0, UnderfullPages(bpm.get(), merged.GetRootPageId()));
+  expected = 1;
+  for (auto it = merged.Begin(); !it.IsEnd(); ++it) {
+    ASSERT_EQ(expected, (*it).second.GetSlotNum());
+    expected++;
+  }
+  EXPECT_EQ(4 * 17 + 2, expected);
+
+  // Scenario: at the default page sizes and fill factor, leaves take 229 pairs and must hold at least 128.
+  bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> large("foo_pk", header_page_id, bpm.get(), comparator);
+  keys.clear();
+  for (int64_t key = 1; key <= 229 * 3 + 1; ++key) {
+    keys.push_back(key);
+  }
+  ASSERT_TRUE(load(&large, keys, 90));
+  EXPECT_EQ(std::vector<int>({229, 229, 230}), LeafSizes(bpm.get(), large.GetRootPageId()));
+  EXPECT_EQ(0, UnderfullPages(bpm.get(), large.GetRootPageId()));
+
+  // Scenario: a buffer pool that runs out of frames fails the load, which leaves the tree empty and frees its pages.
+  auto small_bpm = std::make_unique<BufferPoolManager>(3, disk_manager.get());
+  small_bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> starved("foo_pk", header_page_id, small_bpm.get(), comparator, 5,
+                                                              4);
+  EXPECT_THROW(load(&starved, keys, 100), Exception);
+  EXPECT_TRUE(starved.IsEmpty());
+  std::vector<page_id_t> page_ids(3);
+  for (auto &page_id : page_ids) {
+    EXPECT_NE(nullptr, small_bpm->NewPage(&page_id));
+  }
+  for (auto page_id : page_ids) {
+    small_bpm->UnpinPage(page_id, false);
+  }
+
+  // Scenario: no pairs leave the tree empty.
+  bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> empty("foo_pk", header_page_id, bpm.get(), comparator, 10, 4);
+  ASSERT_TRUE(load(&empty, {}, 100));
+  EXPECT_TRUE(empty.IsEmpty());
+}
+
+TEST(BPlusTreeTests, RangeTest) {
+  using Bound = std::optional<IndexKeyBound<GenericKey<8>>>;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPageGuarded(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page_id, bpm.get(), comparator, 5, 4);
+  auto bound = [](int64_t key, bool inclusive) -> Bound {
+    IndexKeyBound<GenericKey<8>> key_bound{{}, inclusive};
+    key_bound.key_.SetFromInteger(key);
+    return key_bound;
+  };
+  auto scan = [&tree](const Bound &lower, const Bound &upper, bool reverse) {
+    std::vector<int64_t> keys;
+    for (auto it = tree.Range(lower, upper, reverse); !it.IsEnd(); ++it) {
+      keys.push_back((*it).second.GetSlotNum());
+    }
+    return keys;
+  };
+
+  // Scenario: an empty tree has no keys in any range.
+  EXPECT_TRUE(scan(std::nullopt, std::nullopt, false).empty());
+  EXPECT_TRUE(scan(std::nullopt, std::nullopt, true).empty());
+
+  // Scenario: after removes, separators of inner pages are no longer keys of the leaves.
+  std::set<int64_t> keys;
+  GenericKey<8> index_key;
+  for (int64_t key = 2; key <= 400; key += 2) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(0, key)));
+    keys.insert(key);
+  }
+  for (int64_t key = 6; key <= 400; key += 8) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, nullptr);
+    keys.erase(key);
+  }
+
+  // Scenario: bounds on keys and between keys, inclusive or not, on either end and in both directions, give the keys
+  // within them in order.
+  for (int64_t low = -1; low <= 402; low += 3) {
+    for (int64_t high = low - 2; high <= 402; high += 17) {
+      for (int inclusive = 0; inclusive < 4; ++inclusive) {
+        bool lower_inclusive = (inclusive & 1) != 0;
+        bool upper_inclusive = (inclusive & 2) != 0;
+        std::vector<int64_t> expected;
+        for (auto key : keys) {
+          if ((key > low || (lower_inclusive && key == low)) && (key < high || (upper_inclusive && key == high))) {
+            expected.push_back(key);
+          }
+        }
+        ASSERT_EQ(expected, scan(bound(low, lower_inclusive), bound(high, upper_inclusive), false))
+            << "[" << low << ", " << high << "] " << inclusive;
+        std::reverse(expected.begin(), expected.end());
+        ASSERT_EQ(expected, scan(bound(low, lower_inclusive), bound(high, upper_inclusive), true))
+            << "[" << low << ", " << high << "] " << inclusive;
+      }
+    }
+  }
+
+  // Scenario: a missing bound leaves that end open.
+  std::vector<int64_t> expected(keys.begin(), keys.end());
+  EXPECT_EQ(expected, scan(std::nullopt, std::nullopt, false));
+  std::reverse(expected.begin(), expected.end());
+  EXPECT_EQ(expected, scan(std::nullopt, std::nullopt, true));
+  EXPECT_EQ(std::vector<int64_t>({400, 396, 394}), scan(bound(393, true), std::nullopt, true));
+  EXPECT_EQ(std::vector<int64_t>({2, 4, 8}), scan(std::nullopt, bound(10, false), false));
+  EXPECT_EQ(std::vector<int64_t>({8, 4, 2}), scan(std::nullopt, bound(8, true), true));
+
+  // Scenario: an insert into the leaf an iterator is in does not shift the pairs under the iterator.
+  auto it = tree.Range(std::nullopt, std::nullopt, false);
+  ++it;
+  ASSERT_EQ(4, (*it).second.GetSlotNum());
+  index_key.SetFromInteger(3);
+  ASSERT_TRUE(tree.Insert(index_key, RID(0, 3)));
+  std::vector<int64_t> rest;
+  for (++it; !it.IsEnd(); ++it) {
+    rest.push_back((*it).second.GetSlotNum());
+  }
+  EXPECT_EQ(std::vector<int64_t>(keys.upper_bound(4), keys.end()), rest);
+}
+
 TEST(BPlusTreeTests, InsertTest4) {}
 
 TEST(BPlusTreeTests, InsertTest5) {}
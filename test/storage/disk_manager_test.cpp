@@ -10,11 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
 #include <cstring>
+#include <vector>
 
+#include "buffer/buffer_pool_manager.h"
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_scheduler.h"
 
 namespace bustub {
 
@@ -55,6 +60,214 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesSyncTest) {
+  const size_t num_pages = 4;
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[num_pages][BUSTUB_PAGE_SIZE] = {{0}};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  std::vector<const char *> pages;
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(data[i], BUSTUB_PAGE_SIZE, "Page %zu", i + 2);
+    pages.push_back(data[i]);
+  }
+  dm.WritePages(2, pages);
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+  EXPECT_EQ(0, dm.GetNumSyncs());
+
+  for (size_t i = 0; i < num_pages; i++) {
+    dm.ReadPage(static_cast<page_id_t>(i + 2), buf);
+    EXPECT_EQ(std::memcmp(buf, data[i], sizeof(buf)), 0);
+  }
+
+  // a page that was never written reads as zeros, even past the end of the file
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(100, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+  dm.Sync();
+  EXPECT_EQ(1, dm.GetNumSyncs());
+  EXPECT_EQ(0, dm.GetNumFlushes());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreePageMapTest) {
+  std::string db_file("test.db");
+  remove("test.fpm");
+  auto dm = DiskManager(db_file);
+
+  // the changes of the free page map stay in memory until the next sync
+  dm.SetPagesFree(0, 16);
+  dm.SetPageFree(3, false);
+  dm.SetPageFree(20, true);
+  std::vector<page_id_t> expected = {0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 20};
+  EXPECT_EQ(expected, dm.GetFreePages());
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat("test.fpm", &stat_buf));
+  EXPECT_EQ(0, stat_buf.st_size);
+
+  dm.Sync();
+  EXPECT_EQ(expected, DiskManager(db_file).GetFreePages());
+
+  // changes since the last sync are written at shutdown
+  dm.SetPageFree(0, false);
+  dm.ShutDown();
+  expected.erase(expected.begin());
+  EXPECT_EQ(expected, DiskManager(db_file).GetFreePages());
+  remove("test.fpm");
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PreallocatePagesTest) {
+  const size_t num_pages = BUFFER_POOL_EXTENT_SIZE;
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  if (!dm.PreallocatePages(0, num_pages)) {
+    dm.ShutDown();
+    GTEST_SKIP() << "the file system cannot preallocate space";
+  }
+
+  // the space is reserved, but the file does not grow until the pages are written
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_EQ(0, stat_buf.st_size);
+  EXPECT_GE(stat_buf.st_blocks * 512, static_cast<off_t>(num_pages * BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, dm.GetNumPages());
+
+  std::strncpy(data, "A test string.", sizeof(data));
+  dm.WritePage(10, data);
+  dm.ReadPage(10, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(11, dm.GetNumPages());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  const size_t num_pages = 3;
+  // one extra byte, so that buffers at odd offsets are never aligned
+  alignas(BUSTUB_PAGE_SIZE) static char data[num_pages][BUSTUB_PAGE_SIZE + 1];
+  alignas(BUSTUB_PAGE_SIZE) static char buf[BUSTUB_PAGE_SIZE + 1];
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+  if (!dm.IsDirectIo()) {
+    dm.ShutDown();
+    GTEST_SKIP() << "the file system does not support direct I/O";
+  }
+
+  // aligned buffers are used as is, the others go through a bounce buffer
+  std::vector<const char *> pages;
+  for (size_t i = 0; i < num_pages; i++) {
+    char *page = data[i] + i % 2;
+    snprintf(page, BUSTUB_PAGE_SIZE, "Page %zu", i);
+    pages.push_back(page);
+  }
+  dm.WritePage(0, pages[0]);
+  dm.WritePage(1, pages[1]);
+  dm.WritePages(2, pages);
+  dm.WritePages(5, {pages[0], pages[2]});
+  EXPECT_EQ(7, dm.GetNumWrites());
+  EXPECT_EQ(7, dm.GetNumPages());
+
+  std::vector<size_t> expected = {0, 1, 0, 1, 2, 0, 2};
+  for (size_t i = 0; i < expected.size(); i++) {
+    for (size_t misalign = 0; misalign < 2; misalign++) {
+      std::memset(buf, 1, sizeof(buf));
+      dm.ReadPage(static_cast<page_id_t>(i), buf + misalign);
+      EXPECT_EQ(std::memcmp(buf + misalign, pages[expected[i]], BUSTUB_PAGE_SIZE), 0);
+    }
+  }
+
+  // a page past the end of the file still reads as zeros
+  dm.ReadPage(100, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapTest) {
+  const size_t num_pages = 5;
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[num_pages][BUSTUB_PAGE_SIZE] = {{0}};
+  std::string db_file("test.db");
+  EXPECT_THROW(DiskManagerMmap{db_file}, Exception);
+
+  // Scenario: an empty file maps, and all of its pages read as zeros.
+  {
+    auto writer = DiskManager(db_file);
+    writer.ShutDown();
+    auto dm = DiskManagerMmap(db_file);
+    std::memset(buf, 1, sizeof(buf));
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(0, buf[0]);
+    dm.AdviseScan(0);
+  }
+
+  auto writer = DiskManager(db_file);
+  std::vector<const char *> pages;
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(data[i], BUSTUB_PAGE_SIZE, "Page %zu", i);
+    pages.push_back(data[i]);
+  }
+  writer.WritePages(0, pages);
+  writer.ShutDown();
+
+  // Scenario: pages are copied out of the mapping, alone or as a run, and read as zeros past the end of the file.
+  auto dm = DiskManagerMmap(db_file);
+  EXPECT_EQ(num_pages, dm.GetNumPages());
+  for (size_t i = 0; i < num_pages; i++) {
+    dm.AdviseScan(static_cast<page_id_t>(i));
+    dm.ReadPage(static_cast<page_id_t>(i), buf);
+    EXPECT_EQ(std::memcmp(buf, data[i], sizeof(buf)), 0);
+  }
+  std::vector<std::vector<char>> run(3, std::vector<char>(BUSTUB_PAGE_SIZE, 1));
+  dm.ReadPages(3, {run[0].data(), run[1].data(), run[2].data()});
+  EXPECT_EQ(std::memcmp(run[0].data(), data[3], BUSTUB_PAGE_SIZE), 0);
+  EXPECT_EQ(std::memcmp(run[1].data(), data[4], BUSTUB_PAGE_SIZE), 0);
+  EXPECT_EQ(0, run[2][0]);
+  EXPECT_EQ(0, run[2][BUSTUB_PAGE_SIZE - 1]);
+
+  // Scenario: writes are refused, directly and through the disk scheduler, and leave the file unchanged.
+  EXPECT_THROW(dm.WritePage(0, data[1]), Exception);
+  EXPECT_THROW(dm.WritePages(0, pages), Exception);
+  EXPECT_THROW(dm.SetPageFree(0, true), Exception);
+  EXPECT_FALSE(dm.PreallocatePages(0, num_pages));
+  {
+    DiskScheduler scheduler(&dm);
+    EXPECT_FALSE(scheduler.ScheduleIo(true, 0, data[1]).get());
+    EXPECT_TRUE(scheduler.ScheduleIo(false, 0, buf).get());
+  }
+  EXPECT_EQ(std::memcmp(buf, data[0], sizeof(buf)), 0);
+
+  // Scenario: a buffer pool over the mapping refuses to create or delete pages, and keeps all of its frames to fetch.
+  {
+    BufferPoolManager bpm(2, &dm);
+    page_id_t page_id;
+    EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+    EXPECT_FALSE(bpm.DeletePage(1));
+    Page *first = bpm.FetchPage(1);
+    Page *second = bpm.FetchPage(2);
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    EXPECT_EQ(std::memcmp(first->GetData(), data[1], BUSTUB_PAGE_SIZE), 0);
+    EXPECT_EQ(std::memcmp(second->GetData(), data[2], BUSTUB_PAGE_SIZE), 0);
+    bpm.UnpinPage(1, false);
+    bpm.UnpinPage(2, false);
+  }
+  EXPECT_EQ(0, dm.GetNumWrites());
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+/** Holds the first write of page 0 until released, and records how the other writes arrive. */
+class GatedDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    if (page_id == 0 && !gated_.exchange(true)) {
+      entered_.set_value();
+      gate_.wait();
+    }
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) override {
+    batch_sizes_.push_back(pages.size());
+    DiskManagerUnlimitedMemory::WritePages(first_page_id, pages);
+  }
+
+  std::atomic<bool> gated_{false};
+  std::promise<void> entered_;
+  std::promise<void> release_;
+  std::shared_future<void> gate_{release_.get_future()};
+  std::vector<size_t> batch_sizes_;
+};
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto promise1 = disk_scheduler->CreatePromise();
+  auto future1 = promise1.get_future();
+  auto promise2 = disk_scheduler->CreatePromise();
+  auto future2 = promise2.get_future();
+
+  DiskRequest write;
+  write.is_write_ = true;
+  write.data_ = data;
+  write.page_id_ = 0;
+  write.callback_ = std::move(promise1);
+  disk_scheduler->Schedule(std::move(write));
+  ASSERT_TRUE(future1.get());
+
+  DiskRequest read;
+  read.is_write_ = false;
+  read.data_ = buf;
+  read.page_id_ = 0;
+  read.callback_ = std::move(promise2);
+  disk_scheduler->Schedule(std::move(read));
+  ASSERT_TRUE(future2.get());
+
+  ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, CoalesceWritesTest) {
+  const size_t num_pages = 5;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+
+  auto dm = std::make_unique<GatedDiskManager>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get(), 1);
+
+  // Scenario: the only worker is stuck in the write of page 0 while pages 1..4 are queued in order.
+  std::vector<std::future<bool>> writes;
+  for (size_t i = 0; i < num_pages; ++i) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "Page %zu", i);
+    writes.emplace_back(disk_scheduler->ScheduleIo(true, static_cast<page_id_t>(i), pages[i].data()));
+    if (i == 0) {
+      dm->entered_.get_future().wait();
+    }
+  }
+
+  // Scenario: once released, pages 1..4 reach the disk manager as a single write, and every request completes.
+  bool completed = false;
+  DiskRequest read;
+  read.is_write_ = false;
+  read.data_ = pages[0].data();
+  read.page_id_ = 3;
+  read.callback_ = disk_scheduler->CreatePromise();
+  read.on_complete_ = [&completed](bool done) { completed = done; };
+  auto read_done = read.callback_.get_future();
+  disk_scheduler->Schedule(std::move(read));
+
+  dm->release_.set_value();
+  for (auto &write : writes) {
+    ASSERT_TRUE(write.get());
+  }
+  ASSERT_TRUE(read_done.get());
+  ASSERT_TRUE(completed);
+  ASSERT_EQ(std::vector<size_t>{num_pages - 1}, dm->batch_sizes_);
+  ASSERT_EQ(0, strcmp(pages[0].data(), "Page 3"));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleBatchTest) {
+  const size_t num_pages = 70;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+
+  auto dm = std::make_unique<GatedDiskManager>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get(), 1);
+
+  // Scenario: a run of writes queued at once is merged into writes of at most 32 pages.
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> writes;
+  for (size_t i = 0; i < num_pages; ++i) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "Page %zu", i + 1);
+    DiskRequest r;
+    r.is_write_ = true;
+    r.data_ = pages[i].data();
+    r.page_id_ = static_cast<page_id_t>(i + 1);
+    r.callback_ = disk_scheduler->CreatePromise();
+    writes.emplace_back(r.callback_.get_future());
+    requests.emplace_back(std::move(r));
+  }
+  disk_scheduler->Schedule(std::move(requests));
+  for (auto &write : writes) {
+    ASSERT_TRUE(write.get());
+  }
+  ASSERT_EQ((std::vector<size_t>{32, 32, 6}), dm->batch_sizes_);
+
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  dm->ReadPage(40, buf);
+  ASSERT_EQ(0, strcmp(buf, "Page 40"));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, SamePageOrderTest) {
+  char first[BUSTUB_PAGE_SIZE] = "First";
+  char second[BUSTUB_PAGE_SIZE] = "Second";
+  char other[BUSTUB_PAGE_SIZE] = "Other";
+
+  auto dm = std::make_unique<GatedDiskManager>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get(), 4);
+
+  // Scenario: a worker is stuck in a write of page 0, while another write of page 0 and a write of page 5 are queued.
+  auto first_write = disk_scheduler->ScheduleIo(true, 0, first);
+  dm->entered_.get_future().wait();
+  auto second_write = disk_scheduler->ScheduleIo(true, 0, second);
+  auto other_write = disk_scheduler->ScheduleIo(true, 5, other);
+
+  // Scenario: the other workers go on with page 5, but the second write of page 0 waits for the first one.
+  ASSERT_TRUE(other_write.get());
+  EXPECT_EQ(std::future_status::timeout, second_write.wait_for(std::chrono::milliseconds(20)));
+  dm->release_.set_value();
+  ASSERT_TRUE(first_write.get());
+  ASSERT_TRUE(second_write.get());
+
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  dm->ReadPage(0, buf);
+  ASSERT_EQ(0, strcmp(buf, "Second"));
+}
+
+/** Fails every page write, as a disk manager does on an I/O error. */
+class FailingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    throw std::runtime_error("I/O error while writing page " + std::to_string(page_id));
+  }
+};
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, FailedWriteTest) {
+  char data[BUSTUB_PAGE_SIZE] = "Page 0";
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+
+  auto dm = std::make_unique<FailingDiskManager>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+
+  // Scenario: a failed write is reported to its completion handler and its future, not as completed.
+  bool completed = true;
+  DiskRequest write;
+  write.is_write_ = true;
+  write.data_ = data;
+  write.page_id_ = 0;
+  write.callback_ = disk_scheduler->CreatePromise();
+  write.on_complete_ = [&completed](bool done) { completed = done; };
+  auto write_done = write.callback_.get_future();
+  disk_scheduler->Schedule(std::move(write));
+  ASSERT_FALSE(write_done.get());
+  ASSERT_FALSE(completed);
+
+  // Scenario: the worker survives the failure and serves the next request.
+  ASSERT_TRUE(disk_scheduler->ScheduleIo(false, 0, buf).get());
+}
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort_test.cpp
+//
+// Identification: test/storage/external_sort_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/external_sort.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using Sorter = ExternalSorter<GenericKey<8>, RID, GenericComparator<8>>;
+
+TEST(ExternalSortTest, SortTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(20, disk_manager.get());
+  std::mt19937 rng(42);
+
+  for (size_t num_pairs : {0, 100, 20000}) {
+    // Scenario: with a budget of a single page, many pairs spill into more runs than are merged at once.
+    Sorter sorter(bpm.get(), comparator, BUSTUB_PAGE_SIZE);
+    GenericKey<8> key;
+    for (size_t i = 0; i < num_pairs; ++i) {
+      key.SetFromInteger(rng() % 1000);
+      // the slot numbers the pairs in the order they were added
+      sorter.Add(key, RID(0, i));
+    }
+    sorter.Finish();
+    if (num_pairs < Sorter::PAIRS_PER_PAGE) {
+      EXPECT_EQ(0, sorter.NumSpilledRuns());
+    } else {
+      EXPECT_GT(sorter.NumSpilledRuns(), EXTERNAL_SORT_MERGE_FANIN);
+    }
+
+    // Scenario: pairs come out in key order, and pairs of equal keys in the order they were added.
+    std::pair<GenericKey<8>, RID> prev;
+    std::pair<GenericKey<8>, RID> pair;
+    size_t count = 0;
+    while (sorter.Next(&pair)) {
+      if (count > 0) {
+        int cmp = comparator(prev.first, pair.first);
+        ASSERT_LE(cmp, 0);
+        if (cmp == 0) {
+          ASSERT_LT(prev.second.GetSlotNum(), pair.second.GetSlotNum());
+        }
+      }
+      prev = pair;
+      count++;
+    }
+    EXPECT_EQ(num_pairs, count);
+    EXPECT_FALSE(sorter.Next(&pair));
+  }
+
+  // Scenario: a sort that fits into memory spills nothing.
+  Sorter sorter(bpm.get(), comparator);
+  GenericKey<8> key;
+  for (int i = 100; i > 0; --i) {
+    key.SetFromInteger(i);
+    sorter.Add(key, RID(0, i));
+  }
+  sorter.Finish();
+  EXPECT_EQ(0, sorter.NumSpilledRuns());
+  std::pair<GenericKey<8>, RID> pair;
+  for (uint32_t i = 1; i <= 100; ++i) {
+    ASSERT_TRUE(sorter.Next(&pair));
+    EXPECT_EQ(i, pair.second.GetSlotNum());
+  }
+  EXPECT_FALSE(sorter.Next(&pair));
+
+  // Scenario: no page of the runs stays pinned, the whole buffer pool can be pinned again.
+  std::vector<BasicPageGuard> guards;
+  page_id_t page_id;
+  for (int i = 0; i < 20; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    guards.emplace_back(bpm.get(), page);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/key_search.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(GenericKeyTest, IntegerComparatorTest) {
+  // Scenario: only keys of integer columns that fit into the key are compared as integers.
+  EXPECT_TRUE(IntegerComparator<8>::CanCompare(ParseCreateStatement("a bigint").get()));
+  EXPECT_TRUE(IntegerComparator<8>::CanCompare(ParseCreateStatement("a int,b int").get()));
+  EXPECT_FALSE(IntegerComparator<8>::CanCompare(ParseCreateStatement("a bigint,b bigint").get()));
+  EXPECT_TRUE(IntegerComparator<16>::CanCompare(ParseCreateStatement("a bigint,b bigint").get()));
+  EXPECT_FALSE(IntegerComparator<8>::CanCompare(ParseCreateStatement("a double").get()));
+  EXPECT_FALSE(IntegerComparator<64>::CanCompare(ParseCreateStatement("a int,b varchar(8)").get()));
+
+  // Scenario: keys of mixed integer columns, negative ones and ties included, compare as with GenericComparator.
+  auto key_schema = ParseCreateStatement("a int,b smallint,c tinyint");
+  IntegerComparator<8> integer_comparator(key_schema.get());
+  GenericComparator<8> generic_comparator(key_schema.get());
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> dis(-3, 3);
+  auto make_key = [&]() {
+    GenericKey<8> key;
+    std::vector<Value> values{Value(TypeId::INTEGER, dis(rng) * 100000),
+                              Value(TypeId::SMALLINT, static_cast<int16_t>(dis(rng) * 1000)),
+                              Value(TypeId::TINYINT, static_cast<int8_t>(dis(rng) * 40))};
+    key.SetFromKey(Tuple(values, key_schema.get()));
+    return key;
+  };
+  for (int i = 0; i < 10000; ++i) {
+    auto lhs = make_key();
+    auto rhs = make_key();
+    ASSERT_EQ(generic_comparator(lhs, rhs), integer_comparator(lhs, rhs));
+    ASSERT_EQ(0, integer_comparator(lhs, lhs));
+  }
+}
+
+TEST(GenericKeyTest, CountNotGreaterTest) {
+  std::mt19937 rng(42);
+  for (const auto *columns : {"a bigint", "a int", "a int,b smallint"}) {
+    auto key_schema = ParseCreateStatement(columns);
+    IntegerComparator<8> comparator(key_schema.get());
+    auto make_key = [&](int value) {
+      GenericKey<8> key;
+      std::vector<Value> values;
+      for (const auto &col : key_schema->GetColumns()) {
+        if (col.GetType() == TypeId::BIGINT) {
+          values.emplace_back(TypeId::BIGINT, static_cast<int64_t>(value) * 3000000000);
+        } else if (col.GetType() == TypeId::INTEGER) {
+          values.emplace_back(TypeId::INTEGER, value);
+        } else {
+          values.emplace_back(TypeId::SMALLINT, static_cast<int16_t>(value % 3));
+        }
+      }
+      key.SetFromKey(Tuple(values, key_schema.get()));
+      return key;
+    };
+
+    // Scenario: on pages of any size, with duplicates and misses, keys are counted as by an upper bound search.
+    for (int count = 0; count <= 300; count += (count < 40 ? 1 : 37)) {
+      std::vector<int> values;
+      std::uniform_int_distribution<int> dis(-count, count);
+      for (int i = 0; i < count; ++i) {
+        values.push_back(dis(rng));
+      }
+      std::sort(values.begin(), values.end());
+      std::vector<std::pair<GenericKey<8>, RID>> leaf;
+      for (auto value : values) {
+        leaf.emplace_back(make_key(value), RID());
+      }
+      for (int value = -count - 1; value <= count + 1; ++value) {
+        auto key = make_key(value);
+        auto expected = std::upper_bound(leaf.begin(), leaf.end(), key, [&](const auto &key, const auto &pair) {
+                          return comparator(key, pair.first) < 0;
+                        }) -
+                        leaf.begin();
+        ASSERT_EQ(expected, comparator.CountNotGreater(leaf.empty() ? nullptr : leaf[0].first.data_,
+                                                       sizeof(leaf[0]), count, key));
+      }
+    }
+  }
+
+  // Scenario: the scalar and the vectorized kernels agree, whatever the stride.
+  std::vector<int64_t> keys(100);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = static_cast<int64_t>(i / 3) - 10;
+  }
+  for (int64_t key = -12; key < 30; ++key) {
+    auto expected = std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+    const auto *first = reinterpret_cast<const char *>(keys.data());
+    EXPECT_EQ(expected, KeySearch::CountNotGreater(first, sizeof(int64_t), keys.size(), key, false));
+    std::vector<int32_t> keys32(keys.begin(), keys.end());
+    EXPECT_EQ(expected, KeySearch::CountNotGreater(reinterpret_cast<const char *>(keys32.data()), sizeof(int32_t),
+                                                   keys32.size(), static_cast<int32_t>(key), false));
+    if (KeySearch::HasAvx2()) {
+      EXPECT_EQ(expected, KeySearch::CountNotGreater(first, sizeof(int64_t), keys.size(), key, true));
+      EXPECT_EQ(expected, KeySearch::CountNotGreater(reinterpret_cast<const char *>(keys32.data()), sizeof(int32_t),
+                                                     keys32.size(), static_cast<int32_t>(key), true));
+    }
+  }
+}
+
+}  // namespace bustub
@@ -276,4 +276,75 @@ TEST(PageGuardTest, WriteTest2) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
 }
+
+TEST(PageGuardTest, OptimisticReadTest) {
+  const size_t buffer_pool_size = 5;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  bpm->UnpinPage(page_id_temp, false);
+
+  // Reads that no writer interfered with are valid, and other readers do not interfere.
+  {
+    auto optimistic_guard = bpm->FetchPageOptimistic(page_id_temp);
+    EXPECT_EQ(1, page0->GetPinCount());
+    auto reader_guard = bpm->FetchPageRead(page_id_temp);
+    EXPECT_EQ(page0->GetData(), optimistic_guard.GetData());
+    EXPECT_TRUE(optimistic_guard.Validate());
+  }
+  EXPECT_EQ(0, page0->GetPinCount());
+
+  // A writer invalidates the reads until the reader restarts.
+  {
+    auto optimistic_guard = bpm->FetchPageOptimistic(page_id_temp);
+    {
+      auto writer_guard = bpm->FetchPageWrite(page_id_temp);
+      writer_guard.GetDataMut()[0] = 'a';
+      EXPECT_FALSE(optimistic_guard.Validate());
+    }
+    EXPECT_FALSE(optimistic_guard.Validate());
+    optimistic_guard.Restart();
+    EXPECT_TRUE(optimistic_guard.Validate());
+    EXPECT_EQ('a', optimistic_guard.GetData()[0]);
+  }
+  EXPECT_EQ(0, page0->GetPinCount());
+
+  // Upgrading hands the pin over to a read guard, unless a writer got in between.
+  {
+    ReadPageGuard reader_guard;
+    auto optimistic_guard = bpm->FetchPageOptimistic(page_id_temp);
+    EXPECT_TRUE(optimistic_guard.UpgradeRead(&reader_guard));
+    EXPECT_EQ(1, page0->GetPinCount());
+    EXPECT_EQ(page_id_temp, reader_guard.PageId());
+    reader_guard.Drop();
+    EXPECT_EQ(0, page0->GetPinCount());
+
+    optimistic_guard = bpm->FetchPageOptimistic(page_id_temp);
+    bpm->FetchPageWrite(page_id_temp).Drop();
+    EXPECT_FALSE(optimistic_guard.UpgradeRead(&reader_guard));
+    EXPECT_EQ(0, page0->GetPinCount());
+  }
+
+  // Upgrading to a write guard works the same, and the writer invalidates the other optimistic readers.
+  {
+    WritePageGuard writer_guard;
+    auto other_guard = bpm->FetchPageOptimistic(page_id_temp);
+    auto optimistic_guard = bpm->FetchPageOptimistic(page_id_temp);
+    EXPECT_TRUE(optimistic_guard.UpgradeWrite(&writer_guard));
+    EXPECT_EQ(2, page0->GetPinCount());
+    writer_guard.GetDataMut()[0] = 'b';
+    writer_guard.Drop();
+    EXPECT_FALSE(other_guard.Validate());
+    EXPECT_FALSE(other_guard.UpgradeWrite(&writer_guard));
+    EXPECT_EQ(0, page0->GetPinCount());
+    EXPECT_EQ('b', page0->GetData()[0]);
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+}
 }  // namespace bustub
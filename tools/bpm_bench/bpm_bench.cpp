@@ -13,7 +13,7 @@
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -100,6 +100,46 @@ struct BpmMetrics {
   }
 };
 
+/**
+ * Measures the cost of the replacer operations issued by every buffer pool access (pin, record access, unpin) and by
+ * every miss (evict), for growing numbers of frames. The cost per operation should stay (almost) flat.
+ */
+void RunReplacerBench(bustub::ReplacerPolicy policy) {
+  using bustub::frame_id_t;
+
+  static const size_t replacer_bench_ops = 1000000;
+
+  fmt::print("<<< BEGIN\n");
+  for (size_t num_frames = 1024; num_frames <= 262144; num_frames *= 4) {
+    auto replacer_ptr = bustub::MakeReplacer(policy, num_frames, LRU_K_SIZE);
+    auto &replacer = *replacer_ptr;
+    for (size_t i = 0; i < num_frames; i++) {
+      replacer.RecordAccess(static_cast<frame_id_t>(i));
+      replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+    }
+
+    std::default_random_engine gen(num_frames);
+    zipfian_int_distribution<size_t> dist(0, num_frames - 1, 0.8);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < replacer_bench_ops; i++) {
+      auto fid = static_cast<frame_id_t>(dist(gen));
+      if (i % 10 == 0) {
+        // a miss: reuse the victim frame for the new page
+        replacer.Evict(&fid);
+      }
+      replacer.SetEvictable(fid, false);
+      replacer.RecordAccess(fid);
+      replacer.SetEvictable(fid, true);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    fmt::print("frames={:<8} ns_per_access={:.1f}\n", num_frames,
+               static_cast<double>(elapsed.count()) / replacer_bench_ops);
+  }
+  fmt::print(">>> END\n");
+}
+
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
@@ -110,6 +150,25 @@ auto main(int argc, char **argv) -> int {
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
   program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--instances").help("partition the buffer pool into n instances");
+  program.add_argument("--replacer").help("replacement policy: lru-k (default), lru, clock, 2q or arc");
+  program.add_argument("--replacer-bench")
+      .help("measure replacer operations for growing pool sizes instead")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--page-cleaner")
+      .help("write back dirty pages with the background page cleaner")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--admission-filter")
+      .help("admit missed pages through the frequency sketch and the probationary area")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--compressed-cache").help("keep evicted pages compressed in a second tier of n KiB");
+  program.add_argument("--no-scan-hint")
+      .help("issue scan fetches without AccessType::Scan, for comparing scan resistance")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -119,6 +178,17 @@ auto main(int argc, char **argv) -> int {
     return 1;
   }
 
+  auto replacer_policy = bustub::ReplacerPolicy::LRUK;
+  if (program.present("--replacer") && !bustub::ParseReplacerPolicy(program.get("--replacer"), &replacer_policy)) {
+    std::cerr << "unknown replacer " << program.get("--replacer") << std::endl;
+    return 1;
+  }
+
+  if (program.get<bool>("--replacer-bench")) {
+    RunReplacerBench(replacer_policy);
+    return 0;
+  }
+
   uint64_t duration_ms = 30000;
   if (program.present("--duration")) {
     duration_ms = std::stoi(program.get("--duration"));
@@ -129,12 +199,31 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
+  size_t num_instances = 1;
+  if (program.present("--instances")) {
+    num_instances = std::stoi(program.get("--instances"));
+  }
+
+  size_t compressed_cache_kib = 0;
+  if (program.present("--compressed-cache")) {
+    compressed_cache_kib = std::stoi(program.get("--compressed-cache"));
+  }
+
+  auto scan_access = program.get<bool>("--no-scan-hint") ? AccessType::Unknown : AccessType::Scan;
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  auto bpm =
+      std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr, num_instances,
+                                          replacer_policy);
+  bpm->SetCompressedCacheSize(compressed_cache_kib * 1024);
+  bpm->SetAdmissionFilter(program.get<bool>("--admission-filter"));
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, bpm_instances={}, "
+             "replacer={}, compressed_cache_kib={}, admission_filter={}\n",
+             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE, bpm->GetNumInstances(),
+             bustub::ReplacerPolicyToString(replacer_policy), compressed_cache_kib, bpm->HasAdmissionFilter());
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -151,6 +240,9 @@ auto main(int argc, char **argv) -> int {
 
   // enable disk latency after creating all pages
   disk_manager->SetLatency(latency_ms);
+  if (program.get<bool>("--page-cleaner")) {
+    bpm->StartPageCleaner();
+  }
 
   fmt::print(stderr, "[info] benchmark start\n");
 
@@ -160,14 +252,14 @@ auto main(int argc, char **argv) -> int {
   std::vector<std::thread> threads;
 
   for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, scan_access, &total_metrics] {
       BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
       size_t page_idx = BUSTUB_PAGE_CNT * thread_id / BUSTUB_SCAN_THREAD;
 
       while (!metrics.ShouldFinish()) {
-        auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Scan);
+        auto *page = bpm->FetchPage(page_ids[page_idx], scan_access);
         if (page == nullptr) {
           continue;
         }
@@ -180,7 +272,7 @@ auto main(int argc, char **argv) -> int {
         }
         page->WUnlatch();
 
-        bpm->UnpinPage(page->GetPageId(), true, AccessType::Scan);
+        bpm->UnpinPage(page->GetPageId(), true, scan_access);
         page_idx = (page_idx + 1) % BUSTUB_PAGE_CNT;
         metrics.Tick();
         metrics.Report();
@@ -228,5 +320,14 @@ auto main(int argc, char **argv) -> int {
 
   total_metrics.Report();
 
+  const auto &stats = bpm->GetStats();
+  fmt::print(stderr, "[info] get_hit_rate={:.4f}, scan_hit_rate={:.4f}\n", stats.HitRate(AccessType::Get),
+             stats.HitRate(scan_access));
+  fmt::print(stderr, "[info] dirty_evictions={}, cleaner_writes={}\n", stats.dirty_evictions_.load(),
+             stats.cleaner_writes_.load());
+  for (const auto &[name, value] : stats.Describe()) {
+    fmt::print(stderr, "[stats] {}: {}\n", name, value);
+  }
+
   return 0;
 }
@@ -0,0 +1,137 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/rid.h"
+#include "fmt/format.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/key_search.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "test_util.h"
+
+using Key = bustub::GenericKey<8>;
+using Pair = std::pair<Key, bustub::RID>;
+
+static const size_t NUM_PROBES = 1 << 16;
+/** Number of pairs in a full leaf page. */
+static const int FULL_LEAF_SIZE = (bustub::BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(Pair);
+
+/** The search of BPlusTree over a leaf before the kernels: the last key not greater than the probe, or -1. */
+template <typename Comparator>
+auto BinarySearch(const std::vector<Pair> &leaf, const Key &key, const Comparator &comparator) -> int {
+  if (comparator(leaf[0].first, key) == 1) {
+    return -1;
+  }
+  int left = 0;
+  int right = static_cast<int>(leaf.size()) - 1;
+  while (left < right) {
+    int mid = (right + left + 1) / 2;
+    if (comparator(leaf[mid].first, key) != 1) {
+      left = mid;
+    } else {
+      right = mid - 1;
+    }
+  }
+  return right;
+}
+
+/** Run lookups round robin over the probes. @return nanoseconds per lookup, and the sum of the results */
+template <typename Search>
+auto Measure(const std::vector<Key> &probes, size_t lookups, Search search) -> std::pair<double, int64_t> {
+  int64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < lookups; i++) {
+    sum += search(probes[i % NUM_PROBES]);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return {elapsed.count() / lookups, sum};
+}
+
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-key-search-bench");
+  program.add_argument("--key-type").help("bigint or int").default_value(std::string("bigint"));
+  program.add_argument("--lookups").help("lookups per leaf size and search").default_value(std::string("2000000"));
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto key_type = program.get<std::string>("--key-type");
+  if (key_type != "bigint" && key_type != "int") {
+    std::cerr << "unknown key type " << key_type << std::endl;
+    return 1;
+  }
+  size_t lookups = std::stoul(program.get<std::string>("--lookups"));
+  auto key_schema = bustub::ParseCreateStatement("a " + key_type);
+  bustub::GenericComparator<8> generic_comparator(key_schema.get());
+  bustub::IntegerComparator<8> integer_comparator(key_schema.get());
+  auto make_key = [&](int64_t value) {
+    Key key;
+    if (key_type == "bigint") {
+      key.SetFromInteger(value);
+    } else {
+      auto value32 = static_cast<int32_t>(value);
+      memset(key.data_, 0, sizeof(key.data_));
+      memcpy(key.data_, &value32, sizeof(value32));
+    }
+    return key;
+  };
+
+  fmt::print(stderr, "[info] key_type={}, lookups={}, avx2={}\n", key_type, lookups, bustub::KeySearch::HasAvx2());
+  fmt::print("{:>9} {:>12} {:>12} {:>12} {:>12}   (ns per lookup)\n", "leaf_size", "generic", "integer",
+             "kernel", "kernel_avx2");
+
+  std::mt19937 rng(42);
+  for (int leaf_size : {8, 16, 32, 64, 128, FULL_LEAF_SIZE}) {
+    // even keys, and probes that hit them or fall in between, before or after
+    std::vector<Pair> leaf;
+    for (int i = 0; i < leaf_size; i++) {
+      leaf.emplace_back(make_key(2 * i), bustub::RID(0, i));
+    }
+    std::uniform_int_distribution<int64_t> dis(-1, 2 * leaf_size);
+    std::vector<Key> probes;
+    for (size_t i = 0; i < NUM_PROBES; i++) {
+      probes.push_back(make_key(dis(rng)));
+    }
+
+    auto generic = Measure(probes, lookups, [&](const Key &key) {
+      return BinarySearch(leaf, key, generic_comparator);
+    });
+    auto integer = Measure(probes, lookups, [&](const Key &key) {
+      return BinarySearch(leaf, key, integer_comparator);
+    });
+    auto kernel_search = [&](bool vectorized) {
+      return Measure(probes, lookups, [&](const Key &key) -> int {
+        const auto *first = leaf[0].first.data_;
+        if (key_type == "bigint") {
+          return bustub::KeySearch::CountNotGreater(first, sizeof(Pair), leaf.size(),
+                                                    bustub::KeySearch::ReadKey<int64_t>(key.data_), vectorized) -
+                 1;
+        }
+        return bustub::KeySearch::CountNotGreater(first, sizeof(Pair), leaf.size(),
+                                                  bustub::KeySearch::ReadKey<int32_t>(key.data_), vectorized) -
+               1;
+      });
+    };
+    auto kernel = kernel_search(false);
+    auto kernel_avx2 = bustub::KeySearch::HasAvx2() ? kernel_search(true) : std::make_pair(0.0, kernel.second);
+
+    if (integer.second != generic.second || kernel.second != generic.second || kernel_avx2.second != generic.second) {
+      std::cerr << "searches disagree for leaf size " << leaf_size << std::endl;
+      return 1;
+    }
+    fmt::print("{:>9} {:>12.1f} {:>12.1f} {:>12.1f} {:>12.1f}\n", leaf_size, generic.first, integer.first,
+               kernel.first, kernel_avx2.first);
+  }
+
+  return 0;
+}